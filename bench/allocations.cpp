@@ -0,0 +1,112 @@
+/*---------------------------------------------------------------------------*\
+ *                              allocations.cpp                              *
+ *             Check that matrix operations make no needless copies          *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Counts the heap allocations each matrix operation makes, with a        *
+ *      replacement operator new, and fails if any makes more than it        *
+ *      should.  Moves, assignments and compound assignments work in place,  *
+ *      and transposing a square matrix swaps its entries without a new      *
+ *      array, so a change that brings back a copy shows up here as an       *
+ *      allocation over the limit.                                           *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Prints each count against its limit,   *
+ *      and exits with 1 if any is over.                                     *
+ *   -The matrices are small, so that no work is handed to other threads,    *
+ *      which would allocate on their own account.  A product still makes    *
+ *      three allocations:  the result, the right operand transposed for the *
+ *      kernel (see classicProduct), and the thread pool's copy of the task. *
+ *      a.power(5) takes four products, plus a copy of the matrix and the    *
+ *      identity it starts from.                                             *
+\*---------------------------------------------------------------------------*/
+#include<cstdlib>
+#include<new>
+#include "bench.h"
+using namespace std;
+
+static long long allocations = 0;
+
+void *operator new(size_t size)
+{
+  allocations++;
+  void *memory = malloc(size ? size : 1);
+  if (memory == NULL) throw bad_alloc();
+  return memory;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+  free(memory);
+}
+
+
+/*  Returns a matrix built inside a function, to be elided into the caller.  */
+static Matrix built(int rows, int cols)
+{
+  Matrix result(rows, cols);
+  result.set(0, 0, 1);
+  return result;
+}
+
+
+static bool failed = false;
+
+/*  Runs work once, and checks the allocations it made against the limit.    */
+template<class Work> static void check(const char *name, long long limit,
+                                      Work work)
+{
+  long long before = allocations;
+  work();
+  long long count = allocations - before;
+  printf("  %-28s %3lld  (at most %lld)%s\n", name, count, limit,
+         count > limit ? "  TOO MANY" : "");
+  if (count > limit) failed = true;
+}
+
+
+int main()
+{
+  Matrix a = benchMatrix(6, 6, 9, false, 1);
+  Matrix b = benchMatrix(6, 6, 9, false, 2);
+  Matrix wide = benchMatrix(6, 8, 9, false, 3);
+  Matrix c;
+  printf("Heap allocations per operation on 6x6 matrices:\n");
+  check("copy construct", 1, [&] { Matrix m(a); });
+  check("move construct", 0, [&] { Matrix m(move(c)); });
+  check("returned from a function", 1, [&] { Matrix m = built(6, 6); });
+  check("a = b", 0, [&] { a = b; });
+  c = b;
+  check("a = move(c)", 0, [&] { a = move(c); });
+  check("a += b", 0, [&] { a += b; });
+  check("a -= b", 0, [&] { a -= b; });
+  check("a *= 3/2", 0, [&] { a *= Fraction(3, 2); });
+  check("a *= b", 3, [&] { a *= b; });
+  check("c = a * b", 3, [&] { c = a * b; });
+  check("a.transpose(), square", 0, [&] { a.transpose(); });
+  check("transpose(), 6x8", 1, [&] { wide.transpose(); });
+  check("a = -a", 1, [&] { a = -a; });
+  check("a.power(5)", 14, [&] { c = a.power(5); });
+  check("a.determinant()", 1, [&] { a.determinant(); });
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+/*---------------------------------------------------------------------------*\
+ *                                bareiss.cpp                                *
+ *        Benchmark of Bareiss's elimination against rational elimination    *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times determinant() and reduce() on random integer matrices, which     *
+ *      they eliminate by Bareiss's fraction-free method, against the        *
+ *      rational elimination they used before:  dividing each pivot row by   *
+ *      its pivot, and adding multiples of it to the other rows, in          *
+ *      Fractions whose terms grow with every step.                          *
+ *    First with entries in [-3, 3], up to 16x16, where the old way mostly   *
+ *      still fits; then with entries in [-9, 9], up to 200x200, where it    *
+ *      overflows into nan and only the new way's times mean anything.       *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Run with a size to stop the second     *
+ *      table at a smaller one than 200, which takes several seconds.        *
+ *   -The old way is rebuilt here from Matrix's public row operations.       *
+ *      Exits with 1 if it and the new way differ where the old gave no nan, *
+ *      or if the new way gives nan in the second table.                     *
+\*---------------------------------------------------------------------------*/
+#include<cstdlib>
+#include<vector>
+#include "bench.h"
+#include "threadPool.h"
+using namespace std;
+
+static const int SMALL_SIZES[] = {4, 8, 12, 16};
+static const int SMALL_COUNT = 250;
+static const int LARGE_SIZES[] = {25, 50, 100, 200};
+
+
+/*  Returns the row, from first down, whose entry in the column is largest   *
+ *    in magnitude, or -1 if they are all zero, as reduce() chose pivots.    *
+ *    A nan in the first row is kept as the pivot, so that it spreads.       *
+ */
+static int pivotRow(const Matrix &m, int col, int first)
+{
+  int best = first;
+  Fraction bestSize = m.get(first, col);
+  if (bestSize.isNegative()) bestSize = -bestSize;
+  for (int i = first + 1; i < m.getRows(); i++) {
+    Fraction entry = m.get(i, col);
+    Fraction size = entry.isNegative() ? -entry : entry;
+    if (bestSize < size) {
+      best = i;
+      bestSize = size;
+    }
+  }
+  return (bestSize != 0) ? best : -1;
+}
+
+
+/*  The determinant by rational elimination:  the product of the pivots,     *
+ *    negated for each switch of rows.                                       *
+ */
+static Fraction oldDeterminant(Matrix m)
+{
+  Fraction result = 1;
+  int n = m.getRows();
+  for (int j = 0; j < n; j++) {
+    int p = pivotRow(m, j, j);
+    if (p < 0) return 0;
+    if (p != j) {
+      m.switchRows(j, p);
+      result = -result;
+    }
+    Fraction pivot = m.get(j, j);
+    result *= pivot;
+    m.multiplyRow(j, pivot.reciprocal());
+    for (int i = j + 1; i < n; i++) m.addRow(j, -m.get(i, j), i);
+  }
+  return result;
+}
+
+
+/*  The reduced echelon form by rational elimination.                        */
+static void oldReduce(Matrix *m)
+{
+  int row = 0;
+  for (int j = 0; j < m->getCols() && row < m->getRows(); j++) {
+    int p = pivotRow(*m, j, row);
+    if (p < 0) continue;
+    m->switchRows(row, p);
+    m->multiplyRow(row, m->get(row, j).reciprocal());
+    for (int i = 0; i < m->getRows(); i++) {
+      if (i != row) m->addRow(row, -m->get(i, j), i);
+    }
+    row++;
+  }
+}
+
+
+static bool hasNan(const Matrix &m)
+{
+  for (int i = 0; i < m.getRows(); i++) {
+    for (int j = 0; j < m.getCols(); j++) {
+      if (m.get(i, j).isNan()) return true;
+    }
+  }
+  return false;
+}
+
+
+static bool same(const Matrix &a, const Matrix &b)
+{
+  for (int i = 0; i < a.getRows(); i++) {
+    for (int j = 0; j < a.getCols(); j++) {
+      if (a.get(i, j) != b.get(i, j)) return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int largest = (argc > 1) ? atoi(argv[1]) : 200;
+  ThreadPool::shared().resize(1);
+
+  printf("Entries in [-3, 3]; microseconds per call on one thread, and\n");
+  printf("the number of %d matrices for which the old way gave nan:\n",
+         SMALL_COUNT);
+  printf("%6s %12s %12s %12s %12s %9s\n", "size", "old det", "new det",
+         "old reduce", "new reduce", "old nan");
+  for (int n : SMALL_SIZES) {
+    vector<Matrix> inputs;
+    for (int k = 0; k < SMALL_COUNT; k++) {
+      inputs.push_back(benchMatrix(n, n, 3, false, n * 1000 + k));
+    }
+    vector<Fraction> oldDets(SMALL_COUNT), newDets(SMALL_COUNT);
+    vector<Matrix> oldForms(inputs), newForms(inputs);
+    double oldDet = bestTime(3, [&] {
+      for (int k = 0; k < SMALL_COUNT; k++) {
+        oldDets[k] = oldDeterminant(inputs[k]);
+      }
+    });
+    double newDet = bestTime(3, [&] {
+      for (int k = 0; k < SMALL_COUNT; k++) {
+        newDets[k] = inputs[k].determinant();
+      }
+    });
+    double oldReduced = bestTime(1, [&] {
+      for (int k = 0; k < SMALL_COUNT; k++) oldReduce(&oldForms[k]);
+    });
+    double newReduced = bestTime(1, [&] {
+      for (int k = 0; k < SMALL_COUNT; k++) newForms[k].reduce();
+    });
+
+    int oldNan = 0;
+    for (int k = 0; k < SMALL_COUNT; k++) {
+      bool detNan = oldDets[k].isNan(), formNan = hasNan(oldForms[k]);
+      if (detNan || formNan) oldNan++;
+      if ((!detNan && oldDets[k] != newDets[k]) ||
+          (!formNan && !same(oldForms[k], newForms[k]))) {
+        printf("The two ways differ on a %dx%d matrix.\n", n, n);
+        return 1;
+      }
+    }
+    printf("%6d %12.2f %12.2f %12.2f %12.2f %9d\n", n,
+           oldDet / SMALL_COUNT * 1e6, newDet / SMALL_COUNT * 1e6,
+           oldReduced / SMALL_COUNT * 1e6, newReduced / SMALL_COUNT * 1e6,
+           oldNan);
+    fflush(stdout);
+  }
+
+  printf("\nEntries in [-9, 9]; milliseconds to reduce one matrix, and\n");
+  printf("how many of its entries each way left nan:\n");
+  printf("%6s %12s %12s %9s %9s\n", "size", "old reduce", "new reduce",
+         "old nan", "new nan");
+  for (int n : LARGE_SIZES) {
+    if (n > largest) break;
+    Matrix input = benchMatrix(n, n, 9, false, n);
+    Matrix oldForm = input, newForm = input;
+    double oldReduced = bestTime(1, [&] { oldReduce(&oldForm); });
+    double newReduced = bestTime(1, [&] { newForm.reduce(); });
+    int oldNan = 0, newNan = 0;
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        oldNan += oldForm.get(i, j).isNan();
+        newNan += newForm.get(i, j).isNan();
+      }
+    }
+    printf("%6d %12.1f %12.1f %9d %9d\n", n, oldReduced * 1e3,
+           newReduced * 1e3, oldNan, newNan);
+    fflush(stdout);
+    if (newNan > 0 || (oldNan == 0 && !same(oldForm, newForm))) {
+      printf("The new way did not reduce the %dx%d matrix exactly.\n", n, n);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+/*---------------------------------------------------------------------------*\
+ *                                  bench.h                                  *
+ *                  Shared helpers for the benchmark programs                *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times a piece of code, and makes the same pseudo-random inputs on      *
+ *      every run, so that the tables the benchmarks print can be compared   *
+ *      from one build, or one machine, to the next.                         *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Each benchmark is a program of its own, built from the top of the      *
+ *      tree with the calculator's sources, less its main():                 *
+ *        g++ -std=c++17 -O2 -pthread -I. bench/NAME.cpp \                   *
+ *            $(ls *.cpp | grep -v matrixCalc) -o NAME                       *
+ *   -Times are the best of several runs, which is the least disturbed by    *
+ *      whatever else the machine is doing.                                  *
+\*---------------------------------------------------------------------------*/
+#ifndef BENCH_INCLUDED
+#define BENCH_INCLUDED
+#include<chrono>
+#include<cstdio>
+#include "matrix.h"
+using namespace std;
+
+/*  Returns the fewest seconds that any of the given number of calls to      *
+ *    work took.                                                             *
+ */
+template<class Work> double bestTime(int runs, Work work)
+{
+  double best = 0;
+  for (int i = 0; i < runs; i++) {
+    auto start = chrono::steady_clock::now();
+    work();
+    chrono::duration<double> taken = chrono::steady_clock::now() - start;
+    if (i == 0 || taken.count() < best) best = taken.count();
+  }
+  return best;
+}
+
+
+/*  A small linear congruential generator, so that inputs are the same on    *
+ *    every platform; the quality of std::rand() is not needed here.         *
+ */
+class BenchRandom
+{
+ public:
+  BenchRandom(unsigned long long seed) : state(seed) {}
+
+  /*  Returns a number from low to high, inclusive.                          */
+  long long next(long long low, long long high)
+  {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return low + (long long)((state >> 33) % (high - low + 1));
+  }
+
+ private:
+  unsigned long long state;
+};
+
+
+/*  Returns a rows x cols matrix of integers from -range to range, or of     *
+ *    fractions with such numerators and denominators from 1 to range.       *
+ */
+inline Matrix benchMatrix(int rows, int cols, long long range,
+                          bool fractions, unsigned long long seed)
+{
+  BenchRandom random(seed);
+  Matrix result(rows, cols);
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      long long numerator = random.next(-range, range);
+      long long denominator = fractions ? random.next(1, range) : 1;
+      result.set(i, j, Fraction(numerator, denominator));
+    }
+  }
+  return result;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*---------------------------------------------------------------------------*\
+ *                               footprint.cpp                               *
+ *              Benchmark of the memory a matrix of Fractions uses           *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Shows how many bytes a Fraction takes, against the 24 that its         *
+ *      layout took with a separate sign, and what that means for matrices:  *
+ *      the bytes each size of matrix holds, how fast its entries are        *
+ *      copied, as a Matrix and as a plain array, against an array of the    *
+ *      same number of 24-byte entries, and how long operator* and reduce()  *
+ *      take over them.                                                      *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Copies are pure memory traffic, so     *
+ *      the two arrays' rates show the effect of the layout most directly.   *
+ *   -reduce() is timed once; the entries of a reduced integer matrix grow   *
+ *      toward its determinant, so it takes far longer than the product.     *
+\*---------------------------------------------------------------------------*/
+#include<vector>
+#include "bench.h"
+using namespace std;
+
+static const int SIZES[] = {64, 128, 256};
+static const int RUNS = 3;
+
+/*  Fraction as it was laid out before the sign was folded into its          *
+ *    denominator; only its size matters here.                               *
+ */
+struct WideFraction
+{
+  unsigned long long numerator;
+  unsigned long long denominator;
+  bool negative;
+};
+
+
+int main()
+{
+  printf("sizeof(Fraction) = %d bytes; with a separate sign, %d bytes\n",
+         (int)sizeof(Fraction), (int)sizeof(WideFraction));
+  printf("%6s %8s %12s %12s %12s %12s %12s\n", "size", "MB",
+         "Matrix GB/s", "16-byte GB/s", "24-byte GB/s", "product ms",
+         "reduce ms");
+  for (int n : SIZES) {
+    Matrix a = benchMatrix(n, n, 9, false, n);
+    Matrix b = benchMatrix(n, n, 9, false, n + 1);
+    double bytes = (double)n * n * sizeof(Fraction);
+    double wideBytes = (double)n * n * sizeof(WideFraction);
+    vector<Fraction> narrow(n * n, Fraction(1));
+    vector<WideFraction> wide(n * n, WideFraction{1, 1, false});
+
+    double copy = bestTime(RUNS * 3, [&] { Matrix m = a; });
+    double narrowCopy = bestTime(RUNS * 3, [&] {
+      vector<Fraction> v = narrow;
+    });
+    double wideCopy = bestTime(RUNS * 3, [&] {
+      vector<WideFraction> v = wide;
+    });
+    double product = bestTime(RUNS, [&] { Matrix m = a * b; });
+    double reduce = bestTime(1, [&] { Matrix m = a; m.reduce(); });
+    printf("%6d %8.2f %12.2f %12.2f %12.2f %12.1f %12.1f\n", n, bytes / 1e6,
+           bytes / copy / 1e9, bytes / narrowCopy / 1e9,
+           wideBytes / wideCopy / 1e9, product * 1e3, reduce * 1e3);
+  }
+  return 0;
+}
@@ -0,0 +1,221 @@
+/*---------------------------------------------------------------------------*\
+ *                                  gcd.cpp                                  *
+ *            Benchmark of reducing fractions to their lowest terms          *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times Fraction's construction, += and *=, which all reduce their       *
+ *      results by the binary GCD, against the same done the way Fraction    *
+ *      first did:  trial division over terms truncated to int, and a        *
+ *      recursive subtractive Euclid for the least common multiple of two    *
+ *      denominators.  Terms up to 100 are timed both ways, and terms near   *
+ *      10^12 the new way alone.                                             *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Run with a number to take terms up to  *
+ *      it instead of 100; the old way's += slows sharply as they grow.      *
+ *   -Times are per operation, and for a "mixed" step of one of each, in     *
+ *      nanoseconds.                                                         *
+ *   -The old way is not timed on 10^12-sized terms:  its trial division     *
+ *      can run up to 2^31 times, and its Euclid 10^12 times, per call.      *
+ *      Instead one such fraction is shown as it constructs it, wrongly,     *
+ *      since it truncates the terms to int.                                 *
+ *   -Every result of the new way is checked against BigRational; exits      *
+ *      with 1 if one differs.                                               *
+\*---------------------------------------------------------------------------*/
+#include<cstdlib>
+#include<vector>
+#include "bench.h"
+#include "bigRational.h"
+using namespace std;
+
+static const int TERMS = 5000;
+static const int RUNS = 5;
+
+
+/*  Fraction as it was first written, with a separate sign; only what is     *
+ *    timed here is kept.                                                    *
+ */
+struct OldFraction
+{
+  unsigned long long numerator;
+  unsigned long long denominator;
+  bool negative;
+
+  OldFraction() : numerator(0), denominator(1), negative(false) {}
+
+  OldFraction(long long numerator, long long denominator)
+  {
+    negative = ((numerator < 0) != (denominator < 0));
+    this->numerator = (numerator < 0) ? (-numerator) : numerator;
+    this->denominator = (denominator < 0) ? (-denominator) : denominator;
+    reduce(&this->numerator, &this->denominator);
+  }
+
+  static void reduce(unsigned long long *num1, unsigned long long *num2)
+  {
+    int n1 = *num1;
+    int n2 = *num2;
+    for (int i = 2; i <= n1 && i <= n2; i++) {
+      if (n1 % i == 0 && n2 % i == 0) {
+        n1 /= i;
+        n2 /= i;
+      }
+    }
+    *num1 = n1;
+    *num2 = n2;
+  }
+
+  static unsigned long long GCD(unsigned long long num1,
+                                unsigned long long num2)
+  {
+    if (num1 == num2) return num1;
+    if (num1 > num2) return GCD(num2, num1 - num2);
+    return GCD(num1, num2 - num1);
+  }
+
+  static unsigned long long LCM(unsigned long long num1,
+                                unsigned long long num2)
+  {
+    return (num1 / GCD(num1, num2)) * num2;
+  }
+
+  OldFraction &operator+=(OldFraction rhs)
+  {
+    unsigned long long lcm = LCM(denominator, rhs.denominator);
+    numerator *= (lcm / denominator);
+    rhs.numerator *= (lcm / rhs.denominator);
+    if (rhs.negative == negative) {
+      numerator += rhs.numerator;
+    } else if (rhs.numerator > numerator) {
+      numerator = rhs.numerator - numerator;
+      negative = !negative;
+    } else {
+      numerator -= rhs.numerator;
+    }
+    denominator = lcm;
+    reduce(&numerator, &denominator);
+    return *this;
+  }
+
+  OldFraction &operator*=(const OldFraction &rhs)
+  {
+    unsigned long long num = rhs.numerator;
+    unsigned long long den = rhs.denominator;
+    reduce(&numerator, &den);
+    reduce(&num, &denominator);
+    numerator *= num;
+    denominator *= den;
+    if (rhs.negative) negative = !negative;
+    return *this;
+  }
+};
+
+
+/*  Nanoseconds per construction, +=, *= and mixed step, over the given      *
+ *    numerators and denominators; x[i] and x[i + 1] are combined.           *
+ */
+template<class F>
+static void timeOperations(const vector<long long> &nums,
+                           const vector<long long> &dens, double times[4],
+                           vector<F> *sums, vector<F> *products)
+{
+  int count = (int)nums.size() - 1;
+  vector<F> x(count + 1);
+  for (int i = 0; i <= count; i++) x[i] = F(nums[i], dens[i]);
+  sums->assign(count, F());
+  products->assign(count, F());
+  times[0] = bestTime(RUNS, [&] {
+    for (int i = 0; i < count; i++) (*sums)[i] = F(nums[i], dens[i]);
+  });
+  times[1] = bestTime(RUNS, [&] {
+    for (int i = 0; i < count; i++) {
+      (*sums)[i] = x[i];
+      (*sums)[i] += x[i + 1];
+    }
+  });
+  times[2] = bestTime(RUNS, [&] {
+    for (int i = 0; i < count; i++) {
+      (*products)[i] = x[i];
+      (*products)[i] *= x[i + 1];
+    }
+  });
+  vector<F> steps(count);
+  times[3] = bestTime(RUNS, [&] {
+    for (int i = 0; i < count; i++) {
+      F step(nums[i], dens[i]);
+      step += x[i + 1];
+      step *= x[i + 1];
+      steps[i] = step;
+    }
+  });
+  for (int k = 0; k < 4; k++) times[k] = times[k] / count * 1e9;
+}
+
+
+/*  Whether every new sum and product is exact, as BigRational finds it;     *
+ *    those that overflowed to nan are skipped.                              *
+ */
+static bool exact(const vector<long long> &nums, const vector<long long> &dens,
+                  const vector<Fraction> &sums,
+                  const vector<Fraction> &products)
+{
+  for (int i = 0; i < (int)sums.size(); i++) {
+    BigRational x(nums[i], dens[i]), y(nums[i + 1], dens[i + 1]);
+    if (!sums[i].isNan() && BigRational(sums[i]) != x + y) return false;
+    if (!products[i].isNan() && BigRational(products[i]) != x * y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static void printRow(const char *name, const double times[4])
+{
+  printf("%-24s %10.1f %10.1f %10.1f %10.1f\n", name, times[0], times[1],
+         times[2], times[3]);
+}
+
+
+int main(int argc, char *argv[])
+{
+  long long range = (argc > 1) ? atoll(argv[1]) : 100;
+  BenchRandom random(11);
+  vector<long long> smallNums, smallDens, largeNums, largeDens;
+  for (int i = 0; i <= TERMS; i++) {
+    smallNums.push_back(random.next(-range, range));
+    smallDens.push_back(random.next(1, range));
+    largeNums.push_back(random.next(-2000000000000LL, 2000000000000LL));
+    largeDens.push_back(random.next(1000000000000LL, 2000000000000LL));
+  }
+
+  printf("Nanoseconds per operation:\n");
+  printf("%-24s %10s %10s %10s %10s\n", "", "construct", "+=", "*=",
+         "mixed");
+  double times[4];
+  char name[32];
+  vector<OldFraction> oldSums, oldProducts;
+  timeOperations(smallNums, smallDens, times, &oldSums, &oldProducts);
+  snprintf(name, sizeof(name), "old, terms to %lld", range);
+  printRow(name, times);
+  vector<Fraction> sums, products;
+  timeOperations(smallNums, smallDens, times, &sums, &products);
+  snprintf(name, sizeof(name), "new, terms to %lld", range);
+  printRow(name, times);
+  bool ok = exact(smallNums, smallDens, sums, products);
+  timeOperations(largeNums, largeDens, times, &sums, &products);
+  printRow("new, terms near 10^12", times);
+  ok = ok && exact(largeNums, largeDens, sums, products);
+  if (!ok) {
+    printf("A result of the new way is not exact.\n");
+    return 1;
+  }
+
+  OldFraction old(2000000000000LL, 4000000000000LL);
+  Fraction fraction(2000000000000LL, 4000000000000LL);
+  printf("2000000000000/4000000000000 is %llu/%llu the old way, ",
+         old.numerator, old.denominator);
+  printf("and %llu/%llu the new.\n", fraction.getNumerator(),
+         fraction.getDenominator());
+  return 0;
+}
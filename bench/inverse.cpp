@@ -0,0 +1,146 @@
+/*---------------------------------------------------------------------------*\
+ *                                inverse.cpp                                *
+ *        Benchmark of inverse() against inverting by row reduction          *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times Matrix::inverse(), which eliminates on [A | I] in one buffer,    *
+ *      stopping at the first column without a pivot, against the way 'i'    *
+ *      was first meant to work:  building [A | I] as a Matrix, calling      *
+ *      reduce() on it, and taking the right half if the left is the         *
+ *      identity.                                                            *
+ *      Matrices of integers, of halves, and singular ones of each, are      *
+ *      timed at several sizes.                                              *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.                                         *
+ *   -Also counts the matrices each way reports singular, which overflow     *
+ *      can make it do for invertible ones.  Exits with 1 if the two give    *
+ *      different inverses, or if either gives an inverse of a singular      *
+ *      matrix, other than one that overflowed into nan.                     *
+\*---------------------------------------------------------------------------*/
+#include<vector>
+#include "bench.h"
+#include "threadPool.h"
+using namespace std;
+
+/*  One row of the table:  count matrices of the given size, of integers     *
+ *    from -9 to 9, halved if halves is set, and made singular if singular   *
+ *    is set, by making the second column twice the first; inverse() finds   *
+ *    that out in the second step.                                           *
+ */
+struct Case
+{
+  const char *name;
+  int size;
+  bool halves;
+  bool singular;
+  int count;
+};
+
+static const Case CASES[] = {
+  {"halves, 4x4", 4, true, false, 2000},
+  {"halves, 6x6", 6, true, false, 1000},
+  {"halves, 8x8", 8, true, false, 500},
+  {"integers, 8x8", 8, false, false, 500},
+  {"integers, 25x25", 25, false, false, 20},
+  {"integers, 50x50", 50, false, false, 5},
+  {"integers, 100x100", 100, false, false, 1},
+  {"singular integers, 50x50", 50, false, true, 5},
+  {"singular halves, 50x50", 50, true, true, 5},
+};
+
+
+/*  Inverts by reducing [A | I], as described above; a singular matrix       *
+ *    gives the empty matrix, as with inverse().                             *
+ */
+static Matrix reduceInverse(const Matrix &a)
+{
+  int n = a.getRows();
+  Matrix augmented(n, 2 * n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) augmented.set(i, j, a.get(i, j));
+    augmented.set(i, n + i, 1);
+  }
+  augmented.reduce();
+  Matrix result(n, n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      if (augmented.get(i, j) != Fraction(i == j ? 1 : 0)) return Matrix();
+      result.set(i, j, augmented.get(i, n + j));
+    }
+  }
+  return result;
+}
+
+
+static bool hasNan(const Matrix &m)
+{
+  for (int i = 0; i < m.getRows(); i++) {
+    for (int j = 0; j < m.getCols(); j++) {
+      if (m.get(i, j).isNan()) return true;
+    }
+  }
+  return false;
+}
+
+
+static bool same(const Matrix &a, const Matrix &b)
+{
+  for (int i = 0; i < a.getRows(); i++) {
+    for (int j = 0; j < a.getCols(); j++) {
+      if (a.get(i, j) != b.get(i, j)) return false;
+    }
+  }
+  return true;
+}
+
+
+int main()
+{
+  ThreadPool::shared().resize(1);
+  printf("Microseconds per inverse on one thread, and the number of\n");
+  printf("matrices reported singular each way:\n");
+  printf("%-26s %6s %12s %12s %9s %9s\n", "", "count", "reduce()",
+         "inverse()", "singular", "singular");
+  for (const Case &c : CASES) {
+    vector<Matrix> inputs;
+    for (int k = 0; k < c.count; k++) {
+      Matrix m = benchMatrix(c.size, c.size, 9, false, c.size * 10000 + k);
+      if (c.halves) m *= Fraction(1, 2);
+      if (c.singular) {
+        for (int i = 0; i < c.size; i++) m.set(i, 1, m.get(i, 0) * 2);
+      }
+      inputs.push_back(m);
+    }
+    vector<Matrix> reduced(c.count), inverted(c.count);
+    int runs = (c.size < 100) ? 3 : 1;
+    double byReduce = bestTime(runs, [&] {
+      for (int k = 0; k < c.count; k++) reduced[k] = reduceInverse(inputs[k]);
+    }) / c.count;
+    double byInverse = bestTime(runs, [&] {
+      for (int k = 0; k < c.count; k++) inverted[k] = inputs[k].inverse();
+    }) / c.count;
+
+    int reduceSingular = 0, inverseSingular = 0;
+    for (int k = 0; k < c.count; k++) {
+      bool reduceFailed = (reduced[k].getRows() == 0);
+      bool inverseFailed = (inverted[k].getRows() == 0);
+      reduceSingular += reduceFailed;
+      inverseSingular += inverseFailed;
+      bool reduceExact = !reduceFailed && !hasNan(reduced[k]);
+      bool inverseExact = !inverseFailed && !hasNan(inverted[k]);
+      if (c.singular && (reduceExact || inverseExact)) {
+        printf("A matrix of the case \"%s\" was inverted.\n", c.name);
+        return 1;
+      }
+      if (reduceExact && inverseExact && !same(reduced[k], inverted[k])) {
+        printf("The inverses of a %s matrix differ.\n", c.name);
+        return 1;
+      }
+    }
+    printf("%-26s %6d %12.2f %12.2f %9d %9d\n", c.name, c.count,
+           byReduce * 1e6, byInverse * 1e6, reduceSingular, inverseSingular);
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*---------------------------------------------------------------------------*\
+ *                               literals.cpp                                *
+ *                 Benchmark and check of reading number literals            *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    First checks that each literal in a table is read as exactly the       *
+ *      value it names, including those at the edges of the fast paths.      *
+ *    Then measures how fast a few megabytes of generated RPN input, mixing  *
+ *      every form of literal with commands, are read, as the calculator     *
+ *      reads them:  a character at a time, handing each number to           *
+ *      Tokenizer::read.  For comparison, the same input is split into       *
+ *      tokens with an istream's operator>>, as the calculator used to read  *
+ *      it, without even converting the numbers.                             *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Exits with 1 if a literal is misread.  *
+\*---------------------------------------------------------------------------*/
+#include<sstream>
+#include<string>
+#include "bench.h"
+#include "tokenizer.h"
+using namespace std;
+
+static const int LITERALS = 400000;
+static const int RUNS = 5;
+
+/*  Each literal, and the numerator and denominator it should be read as.    */
+static const char *const TABLE[][3] = {
+  {"42", "42", "1"},
+  {"3.14", "157", "50"},
+  {".5", "1", "2"},
+  {"2.", "2", "1"},
+  {"-0.125", "-1", "8"},
+  {"1.5e-7", "3", "20000000"},
+  {"6E23", "600000000000000000000000", "1"},
+  {"2/3", "2", "3"},
+  {"1.5/7", "3", "14"},
+  {"1e3/7", "1000", "7"},
+  {"9999999999999999999", "9999999999999999999", "1"},
+  {"10000000000000000000", "10000000000000000000", "1"},
+  {"123456789012345678901234567890", "123456789012345678901234567890", "1"},
+  {"1e-18", "1", "1000000000000000000"},
+  {"1e-19", "1", "10000000000000000000"},
+  {".0000000000000000003", "3", "10000000000000000000"},
+  {"9999999999999999999e-19", "9999999999999999999", "10000000000000000000"},
+};
+
+
+/*  Returns whether each literal in TABLE reads as its value, printing any   *
+ *    that do not.                                                           *
+ */
+static bool checkTable()
+{
+  bool good = true;
+  for (const auto &row : TABLE) {
+    istringstream input(row[0]);
+    Tokenizer tokenizer(input);
+    BigRational value;
+    BigInteger numerator(row[1]), denominator(row[2]);
+    BigRational expected(numerator, denominator);
+    if (!tokenizer.read(&value) || value != expected) {
+      printf("Misread %s as ", row[0]);
+      value.print(cout);
+      cout << endl;
+      good = false;
+    }
+  }
+  return good;
+}
+
+
+/*  Returns input for the calculator:  LITERALS literals of every form,      *
+ *    separated by spaces and commands, a few to a line.                     *
+ */
+static string makeInput()
+{
+  BenchRandom random(9);
+  string input;
+  const char commands[] = "+-*/d";
+  for (int i = 0; i < LITERALS; i++) {
+    string digits = to_string(random.next(1, 999999999));
+    switch (random.next(0, 3)) {
+    case 0: input += digits;
+      break;
+    case 1: input += digits.substr(0, 3) + "." + digits.substr(3);
+      break;
+    case 2:
+      input += digits.substr(0, 2) + "e-" + to_string(random.next(1, 30));
+      break;
+    default: input += digits.substr(0, 4) + "/" + digits.substr(4);
+    }
+    input += ' ';
+    if (i % 2 == 1) input += commands[random.next(0, 4)];
+    input += (i % 8 == 7) ? '\n' : ' ';
+  }
+  return input;
+}
+
+
+int main()
+{
+  if (!checkTable()) return 1;
+  printf("All %d literals in the table read exactly.\n",
+         (int)(sizeof(TABLE) / sizeof(TABLE[0])));
+
+  string input = makeInput();
+  int count = 0;
+  double tokenizer = bestTime(RUNS, [&] {
+    istringstream stream(input);
+    Tokenizer tokens(stream);
+    BigRational number;
+    char c;
+    count = 0;
+    while (tokens.get(c)) {
+      if (isdigit((unsigned char)c) || c == '.') {
+        tokens.putback();
+        if (tokens.read(&number)) count++;
+      }
+    }
+  });
+  if (count != LITERALS) {
+    printf("Read %d literals of %d.\n", count, LITERALS);
+    return 1;
+  }
+  double istream = bestTime(RUNS, [&] {
+    istringstream stream(input);
+    string token;
+    while (stream >> token) {}
+  });
+
+  double megabytes = input.size() / 1e6;
+  printf("Reading %.1f MB holding %d literals:\n", megabytes, LITERALS);
+  printf("  Tokenizer, converting exactly  %7.1f MB/s  %6.2f M literals/s\n",
+         megabytes / tokenizer, LITERALS / tokenizer / 1e6);
+  printf("  istream >> string, unconverted %7.1f MB/s  %6.2f M literals/s\n",
+         megabytes / istream, LITERALS / istream / 1e6);
+  return 0;
+}
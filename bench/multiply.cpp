@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------------*\
+ *                               multiply.cpp                                *
+ *          Benchmark of the matrix product kernel over a range of sizes     *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times operator* on square matrices from 8 to 1024, of Fractions and    *
+ *      of doubles, against the textbook loop that walks down the right      *
+ *      matrix's columns an entry at a time, as operator* used to.  Threads  *
+ *      and Strassen's method are turned off, so that the tiled kernel of    *
+ *      blockMultiply.h is measured alone.                                   *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Run with a size to stop at a smaller   *
+ *      one than 1024; the whole sweep takes a minute or two.                *
+ *   -Times are per multiply-add, so that sizes can be compared directly.    *
+ *      Exits with 1 if the kernel's product differs from the loop's.        *
+\*---------------------------------------------------------------------------*/
+#include<cstdlib>
+#include "bench.h"
+#include "threadPool.h"
+using namespace std;
+
+/*  The product as first written, through get() and set().                   */
+template<class T>
+static BasicMatrix<T> textbookProduct(const BasicMatrix<T> &a,
+                                      const BasicMatrix<T> &b)
+{
+  BasicMatrix<T> result(a.getRows(), b.getCols());
+  for (int i = 0; i < a.getRows(); i++) {
+    for (int j = 0; j < b.getCols(); j++) {
+      T sum = 0;
+      for (int k = 0; k < a.getCols(); k++) sum += a.get(i, k) * b.get(k, j);
+      result.set(i, j, sum);
+    }
+  }
+  return result;
+}
+
+
+static BasicMatrix<double> toDoubles(const Matrix &m)
+{
+  return convertMatrix<double>(m, [](const Fraction &x) {
+    return (double)x.getNumerator() * (x.isNegative() ? -1 : 1)
+      / x.getDenominator();
+  });
+}
+
+
+/*  Prints the nanoseconds per multiply-add taken by the kernel and by the   *
+ *    textbook loop on n x n matrices.  Returns whether their products       *
+ *    agree; the entries are small integers, so even doubles are exact.      *
+ */
+template<class T>
+static bool sweep(int n, const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+  double operations = (double)n * n * n;
+  int runs = (operations < 1e7) ? 5 : 1;
+  BasicMatrix<T> product;
+  double kernel = bestTime(runs, [&] { product = a * b; });
+  BasicMatrix<T> check;
+  double loop = bestTime(runs, [&] { check = textbookProduct(a, b); });
+  printf("  %12.2f  %12.2f", kernel / operations * 1e9,
+         loop / operations * 1e9);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      if (!(product.get(i, j) == check.get(i, j))) return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int largest = (argc > 1) ? atoi(argv[1]) : 1024;
+  ThreadPool::shared().resize(1);
+  Matrix::strassenThreshold = 0;
+  BasicMatrix<double>::strassenThreshold = 0;
+
+  printf("Nanoseconds per multiply-add, on one thread:\n");
+  printf("%6s  %12s  %12s  %12s  %12s\n", "size", "Fraction", "textbook",
+         "double", "textbook");
+  for (int n = 8; n <= largest; n *= 2) {
+    Matrix a = benchMatrix(n, n, 9, false, n);
+    Matrix b = benchMatrix(n, n, 9, false, n + 1);
+    printf("%6d", n);
+    bool agree = sweep(n, a, b) && sweep(n, toDoubles(a), toDoubles(b));
+    printf("\n");
+    if (!agree) {
+      printf("The kernel and the textbook loop disagree.\n");
+      return 1;
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
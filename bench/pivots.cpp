@@ -0,0 +1,89 @@
+/*---------------------------------------------------------------------------*\
+ *                                pivots.cpp                                 *
+ *               Benchmark of Fraction comparison and pivot search           *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Measures what comparing fractions costs when choosing pivots.  A scan  *
+ *      for the entry of largest magnitude, as getPivot makes down each      *
+ *      column, is timed with Fraction's comparison, by 128-bit cross-       *
+ *      multiplication, and with the subtraction it replaced, which reduced  *
+ *      a difference only to test its sign.  Then reduce() is timed on a     *
+ *      tall matrix, where the scans are most of the work, and on a square   *
+ *      one, where the row arithmetic is.                                    *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Times are per entry scanned, and per   *
+ *      call to reduce().                                                    *
+\*---------------------------------------------------------------------------*/
+#include<vector>
+#include "bench.h"
+using namespace std;
+
+static const int SCAN_ENTRIES = 4000;
+static const int RUNS = 20;
+
+
+/*  The comparison as it was first written:  the sign of the difference.     */
+static bool lessBySubtraction(const Fraction &lhs, const Fraction &rhs)
+{
+  return (lhs - rhs).isNegative();
+}
+
+
+/*  Returns the index of the entry of largest magnitude, comparing with      *
+ *    less, as getPivot does along a column.                                 *
+ */
+template<class Less>
+static int largestEntry(const vector<Fraction> &entries, Less less)
+{
+  int best = 0;
+  Fraction bestSize = entries[0].isNegative() ? -entries[0] : entries[0];
+  for (int i = 1; i < (int)entries.size(); i++) {
+    Fraction size = entries[i].isNegative() ? -entries[i] : entries[i];
+    if (less(bestSize, size)) {
+      best = i;
+      bestSize = size;
+    }
+  }
+  return best;
+}
+
+
+int main()
+{
+  BenchRandom random(7);
+  vector<Fraction> column;
+  for (int i = 0; i < SCAN_ENTRIES; i++) {
+    column.push_back(Fraction(random.next(-1000000, 1000000),
+                              random.next(1, 1000000)));
+  }
+
+  int found[2];
+  double subtraction = bestTime(RUNS, [&] {
+    found[0] = largestEntry(column, lessBySubtraction);
+  });
+  double crossMultiplication = bestTime(RUNS, [&] {
+    found[1] = largestEntry(column, [](const Fraction &lhs,
+                                       const Fraction &rhs) {
+      return lhs < rhs;
+    });
+  });
+  if (found[0] != found[1]) {
+    printf("The two comparisons chose different pivots.\n");
+    return 1;
+  }
+  printf("Pivot scan of %d random fractions, per entry:\n", SCAN_ENTRIES);
+  printf("  by subtraction         %8.1f ns\n",
+         subtraction / SCAN_ENTRIES * 1e9);
+  printf("  by cross-multiplication%8.1f ns\n",
+         crossMultiplication / SCAN_ENTRIES * 1e9);
+
+  Matrix tall = benchMatrix(SCAN_ENTRIES, 4, 1000000, true, 11);
+  Matrix square = benchMatrix(40, 40, 9, false, 13);
+  printf("reduce(), per call:\n");
+  printf("  %dx4 random fractions  %8.2f ms\n", SCAN_ENTRIES,
+         bestTime(RUNS, [&] { Matrix m = tall; m.reduce(); }) * 1e3);
+  printf("  40x40 small integers     %8.2f ms\n",
+         bestTime(RUNS, [&] { Matrix m = square; m.reduce(); }) * 1e3);
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*---------------------------------------------------------------------------*\
+ *                                storage.cpp                                *
+ *           Benchmark of contiguous storage against arrays of rows          *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times constructing, copying and multiplying matrices stored as one     *
+ *      contiguous array, as Matrix stores them, against the same done with  *
+ *      an array of separately allocated rows, as Matrix used to:  one       *
+ *      allocation per row plus one for the row pointers.                    *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.                                         *
+ *   -The row-array product is the textbook loop, walking down the right     *
+ *      matrix's columns, as the old operator* did; Matrix's product also    *
+ *      has its later tiling and threads, so that column shows everything    *
+ *      since, not the storage alone.                                        *
+\*---------------------------------------------------------------------------*/
+#include "bench.h"
+using namespace std;
+
+static const int SIZES[] = {16, 64, 256};
+static const int RUNS = 5;
+
+
+/*  A matrix kept as an array of rows, each allocated on its own.            */
+class RowMatrix
+{
+ public:
+  RowMatrix(int rows, int cols) : rows(rows), cols(cols)
+  {
+    data = new Fraction *[rows];
+    for (int i = 0; i < rows; i++) data[i] = new Fraction[cols];
+  }
+
+  RowMatrix(const RowMatrix &rval) : RowMatrix(rval.rows, rval.cols)
+  {
+    for (int i = 0; i < rows; i++) {
+      for (int j = 0; j < cols; j++) data[i][j] = rval.data[i][j];
+    }
+  }
+
+  ~RowMatrix()
+  {
+    for (int i = 0; i < rows; i++) delete [] data[i];
+    delete [] data;
+  }
+
+  RowMatrix operator*(const RowMatrix &rval) const
+  {
+    RowMatrix result(rows, rval.cols);
+    for (int i = 0; i < rows; i++) {
+      for (int j = 0; j < rval.cols; j++) {
+        Fraction sum;
+        for (int k = 0; k < cols; k++) sum += data[i][k] * rval.data[k][j];
+        result.data[i][j] = sum;
+      }
+    }
+    return result;
+  }
+
+  Fraction **data;
+  int rows;
+  int cols;
+};
+
+
+static RowMatrix toRows(const Matrix &m)
+{
+  RowMatrix result(m.getRows(), m.getCols());
+  for (int i = 0; i < m.getRows(); i++) {
+    for (int j = 0; j < m.getCols(); j++) result.data[i][j] = m.get(i, j);
+  }
+  return result;
+}
+
+
+int main()
+{
+  printf("Times in microseconds; rows = an array of rows, one = contiguous\n");
+  printf("%6s %10s %10s %10s %10s %12s %12s\n", "size", "new rows",
+         "new one", "copy rows", "copy one", "mult rows", "mult one");
+  for (int n : SIZES) {
+    Matrix a = benchMatrix(n, n, 9, false, n);
+    Matrix b = benchMatrix(n, n, 9, false, n + 1);
+    RowMatrix ra = toRows(a), rb = toRows(b);
+    int repeats = 65536 / (n * n) + 1;
+
+    double newRows = bestTime(RUNS, [&] {
+      for (int i = 0; i < repeats; i++) RowMatrix m(n, n);
+    }) / repeats;
+    double newOne = bestTime(RUNS, [&] {
+      for (int i = 0; i < repeats; i++) Matrix m(n, n);
+    }) / repeats;
+    double copyRows = bestTime(RUNS, [&] {
+      for (int i = 0; i < repeats; i++) RowMatrix m(ra);
+    }) / repeats;
+    double copyOne = bestTime(RUNS, [&] {
+      for (int i = 0; i < repeats; i++) Matrix m(a);
+    }) / repeats;
+    double multRows = bestTime(RUNS, [&] { RowMatrix m = ra * rb; });
+    double multOne = bestTime(RUNS, [&] { Matrix m = a * b; });
+
+    RowMatrix check = ra * rb;
+    Matrix product = a * b;
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        if (check.data[i][j] != product.get(i, j)) {
+          printf("The products differ at %d, %d.\n", i + 1, j + 1);
+          return 1;
+        }
+      }
+    }
+    printf("%6d %10.2f %10.2f %10.2f %10.2f %12.1f %12.1f\n", n,
+           newRows * 1e6, newOne * 1e6, copyRows * 1e6, copyOne * 1e6,
+           multRows * 1e6, multOne * 1e6);
+  }
+  return 0;
+}
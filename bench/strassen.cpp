@@ -0,0 +1,76 @@
+/*---------------------------------------------------------------------------*\
+ *                                strassen.cpp                               *
+ *          Benchmark of Strassen's method against the tiled product         *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Locates Matrix::strassenThreshold, the size above which operator*      *
+ *      splits a product into seven half-size ones.  Times products of       *
+ *      square matrices of several sizes, some needing padding, with         *
+ *      Strassen's method off and with each of several thresholds, on one    *
+ *      thread, and checks that every threshold gives the same product.      *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Run with a size to stop at a smaller   *
+ *      one than 512.                                                        *
+ *   -The threshold should be about the smallest at which no larger size     *
+ *      is slower than with the method off.  Exits with 1 if any threshold   *
+ *      gives a different product.                                           *
+\*---------------------------------------------------------------------------*/
+#include<cstdlib>
+#include "bench.h"
+#include "threadPool.h"
+using namespace std;
+
+static const int SIZES[] = {64, 96, 128, 192, 256, 384, 512};
+static const int THRESHOLDS[] = {0, 16, 32, 64, 128};
+static const int COUNT = sizeof(THRESHOLDS) / sizeof(THRESHOLDS[0]);
+
+
+static bool same(const Matrix &a, const Matrix &b)
+{
+  for (int i = 0; i < a.getRows(); i++) {
+    for (int j = 0; j < a.getCols(); j++) {
+      if (a.get(i, j) != b.get(i, j)) return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int largest = (argc > 1) ? atoi(argv[1]) : 512;
+  ThreadPool::shared().resize(1);
+
+  printf("Milliseconds per product on one thread, by strassenThreshold\n");
+  printf("(0 is off), with the speedup over off:\n");
+  printf("%6s", "size");
+  for (int threshold : THRESHOLDS) printf("  %16d", threshold);
+  printf("\n");
+  for (int n : SIZES) {
+    if (n > largest) break;
+    Matrix a = benchMatrix(n, n, 9, false, n);
+    Matrix b = benchMatrix(n, n, 9, false, n + 1);
+    int runs = (n <= 128) ? 3 : 1;
+    Matrix classic;
+    double off = 0;
+    printf("%6d", n);
+    for (int i = 0; i < COUNT; i++) {
+      Matrix::strassenThreshold = THRESHOLDS[i];
+      Matrix product;
+      double time = bestTime(runs, [&] { product = a * b; });
+      if (i == 0) {
+        classic = product;
+        off = time;
+      } else if (!same(product, classic)) {
+        printf("\nA threshold of %d gave a different product.\n",
+               THRESHOLDS[i]);
+        return 1;
+      }
+      printf("  %9.1f (%4.2fx)", time * 1e3, off / time);
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*---------------------------------------------------------------------------*\
+ *                                threads.cpp                                *
+ *             Benchmark of matrix arithmetic across thread counts           *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Times the operations that are split across the shared thread pool,     *
+ *      operator*, operator+=, scalar *= and transpose, with 1, 2, 4, ...    *
+ *      threads up to the number of processors, and checks that every count  *
+ *      gives exactly the result that one thread does.                       *
+ *    Then locates PARALLEL_GRAIN in threadPool.cpp, the fewest operations   *
+ *      on entries a block should hold:  a long run of Fraction additions    *
+ *      is split into blocks of each size in turn, and timed on all the      *
+ *      threads against one.  The grain is about the smallest block that     *
+ *      gains most of the speedup the largest do.                            *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Build as described in bench.h.  Run with a thread count to go up to    *
+ *      that many instead of the number of processors.                       *
+ *   -Exits with 1 if any thread count gives a different result.             *
+\*---------------------------------------------------------------------------*/
+#include<cstdlib>
+#include<thread>
+#include<vector>
+#include "bench.h"
+#include "threadPool.h"
+using namespace std;
+
+static const int PRODUCT_SIZE = 128;
+static const int ELEMENTWISE_SIZE = 1024;
+static const int GRAIN_ENTRIES = 1 << 20;
+static const int RUNS = 3;
+
+
+/*  The results of each operation, to compare across thread counts.          */
+struct Results
+{
+  Matrix product, sum, scaled, transposed;
+};
+
+
+static bool same(const Matrix &a, const Matrix &b)
+{
+  if (a.getRows() != b.getRows() || a.getCols() != b.getCols()) return false;
+  for (int i = 0; i < a.getRows(); i++) {
+    for (int j = 0; j < a.getCols(); j++) {
+      if (a.get(i, j) != b.get(i, j)) return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int most = (argc > 1) ? atoi(argv[1]) : (int)thread::hardware_concurrency();
+  if (most < 1) most = 1;
+  Matrix a = benchMatrix(PRODUCT_SIZE, PRODUCT_SIZE, 100, true, 1);
+  Matrix b = benchMatrix(PRODUCT_SIZE, PRODUCT_SIZE, 100, true, 2);
+  Matrix c = benchMatrix(ELEMENTWISE_SIZE, ELEMENTWISE_SIZE, 100, true, 3);
+  Matrix d = benchMatrix(ELEMENTWISE_SIZE, ELEMENTWISE_SIZE, 100, true, 4);
+
+  printf("Milliseconds, with the speedup over one thread:\n");
+  printf("%7s  %16s  %16s  %16s  %16s\n", "threads", "128 product",
+         "1024 +=", "1024 *= 2/3", "1024 transpose");
+  Results serial;
+  double base[4];
+  for (int threads = 1; threads <= most; threads *= 2) {
+    ThreadPool::shared().resize(threads);
+    Results results;
+    double times[4];
+    times[0] = bestTime(RUNS, [&] { results.product = a * b; });
+    times[1] = bestTime(RUNS, [&] { results.sum = c; results.sum += d; });
+    times[2] = bestTime(RUNS, [&] {
+      results.scaled = c;
+      results.scaled *= Fraction(2, 3);
+    });
+    times[3] = bestTime(RUNS, [&] {
+      results.transposed = c;
+      results.transposed.transpose();
+    });
+    if (threads == 1) {
+      serial = results;
+      for (int i = 0; i < 4; i++) base[i] = times[i];
+    } else if (!same(results.product, serial.product) ||
+               !same(results.sum, serial.sum) ||
+               !same(results.scaled, serial.scaled) ||
+               !same(results.transposed, serial.transposed)) {
+      printf("%d threads gave a different result.\n", threads);
+      return 1;
+    }
+    printf("%7d", threads);
+    for (int i = 0; i < 4; i++) {
+      printf("  %9.1f (%4.1fx)", times[i] * 1e3, base[i] / times[i]);
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+
+  ThreadPool &pool = ThreadPool::shared();
+  vector<Fraction> x(GRAIN_ENTRIES), y(GRAIN_ENTRIES), sum(GRAIN_ENTRIES);
+  BenchRandom random(5);
+  for (int i = 0; i < GRAIN_ENTRIES; i++) {
+    x[i] = Fraction(random.next(-100, 100), random.next(1, 100));
+    y[i] = Fraction(random.next(-100, 100), random.next(1, 100));
+  }
+  auto addBlocks = [&](int block) {
+    pool.parallelFor(GRAIN_ENTRIES, block, [&](int begin, int end) {
+      for (int i = begin; i < end; i++) sum[i] = x[i] + y[i];
+    });
+  };
+  pool.resize(1);
+  double oneThread = bestTime(RUNS, [&] { addBlocks(GRAIN_ENTRIES); });
+  pool.resize(most);
+  printf("Adding %d Fractions on %d threads, by block size:\n",
+         GRAIN_ENTRIES, most);
+  for (int block = 64; block <= GRAIN_ENTRIES / most; block *= 4) {
+    double split = bestTime(RUNS, [&] { addBlocks(block); });
+    printf("  %7d entries  %8.2f ms  (%4.1fx)\n", block, split * 1e3,
+           oneThread / split);
+  }
+  return 0;
+}
@@ -0,0 +1,901 @@
+/*---------------------------------------------------------------------------*\
+ *                              bigInteger.cpp                               *
+ *                    Implementation of the BigInteger class                 *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    The magnitude is an array of "size" 64-bit limbs, least significant    *
+ *    first, with no leading zero limbs; zero has a size of 0.  While the    *
+ *    magnitude fits in one limb, it lives in "small" and "limbs" is NULL.   *
+ *    Once it grows, it moves to a heap array of "capacity" limbs, and stays *
+ *    there even if it later shrinks, so that the space can be reused.       *
+ *    data() hides the difference from the general routines.                 *
+\*---------------------------------------------------------------------------*/
+#include<iostream>
+#include<string>
+#include<vector>
+#include<cctype>
+#include<math.h>
+#include "bigInteger.h"
+using namespace std;
+
+typedef unsigned __int128 uint128;
+
+/*  Decimal conversion works in chunks of the largest power of ten that      *
+ *    fits in a limb.                                                        *
+ */
+static const unsigned long long CHUNK = 10000000000000000000ULL;
+static const int CHUNK_DIGITS = 19;
+
+
+BigInteger::BigInteger()
+{
+  negative = false;
+  size = 0;
+  capacity = 0;
+  small = 0;
+  limbs = NULL;
+}
+
+
+BigInteger::BigInteger(long long number)
+{
+  negative = (number < 0);
+  capacity = 0;
+  small = negative ? 0ULL - (unsigned long long)number : number;
+  size = (small != 0);
+  limbs = NULL;
+}
+
+
+BigInteger::BigInteger(unsigned long long magnitude, bool negative)
+{
+  this->negative = negative && magnitude != 0;
+  capacity = 0;
+  small = magnitude;
+  size = (magnitude != 0);
+  limbs = NULL;
+}
+
+
+/*  Reads the digits a chunk at a time, so that most of the work is done     *
+ *    with single-limb arithmetic.                                           *
+ */
+BigInteger::BigInteger(const string &digits)
+{
+  negative = false;
+  size = 0;
+  capacity = 0;
+  small = 0;
+  limbs = NULL;
+  size_t i = 0;
+  bool minus = false;
+  if (i < digits.size() && digits[i] == '-') {
+    minus = true;
+    i++;
+  }
+  while (i < digits.size() && isdigit(digits[i])) {
+    unsigned long long chunk = 0;
+    unsigned long long scale = 1;
+    for (int j = 0; j < CHUNK_DIGITS && i < digits.size() &&
+	   isdigit(digits[i]); j++, i++) {
+      chunk = chunk * 10 + (digits[i] - '0');
+      scale *= 10;
+    }
+    multiplySmall(scale, chunk);
+  }
+  negative = minus && size != 0;
+}
+
+
+BigInteger::BigInteger(const BigInteger &rval)
+{
+  negative = rval.negative;
+  size = 0;
+  capacity = 0;
+  small = 0;
+  limbs = NULL;
+  reserve(rval.size);
+  const unsigned long long *from = rval.data();
+  unsigned long long *to = data();
+  for (int i = 0; i < rval.size; i++) {
+    to[i] = from[i];
+  }
+  size = rval.size;
+}
+
+
+BigInteger &BigInteger::operator=(const BigInteger &rval)
+{
+  if (this == &rval) return *this;
+  reserve(rval.size);
+  const unsigned long long *from = rval.data();
+  unsigned long long *to = data();
+  for (int i = 0; i < rval.size; i++) {
+    to[i] = from[i];
+  }
+  size = rval.size;
+  negative = rval.negative;
+  return *this;
+}
+
+
+BigInteger::~BigInteger()
+{
+  delete [] limbs;
+}
+
+
+void BigInteger::swap(BigInteger &other)
+{
+  std::swap(negative, other.negative);
+  std::swap(size, other.size);
+  std::swap(capacity, other.capacity);
+  std::swap(small, other.small);
+  std::swap(limbs, other.limbs);
+}
+
+
+bool BigInteger::isZero() const
+{
+  return size == 0;
+}
+
+
+bool BigInteger::isNegative() const
+{
+  return negative;
+}
+
+
+bool BigInteger::isSmall() const
+{
+  return size <= 1;
+}
+
+
+unsigned long long BigInteger::getSmall() const
+{
+  return (size == 0) ? 0 : data()[0];
+}
+
+
+unsigned BigInteger::bitLength() const
+{
+  if (size == 0) return 0;
+  return 64 * size - __builtin_clzll(data()[size - 1]);
+}
+
+
+BigInteger BigInteger::operator-() const
+{
+  BigInteger result(*this);
+  if (result.size != 0) result.negative = !result.negative;
+  return result;
+}
+
+
+/*  Must account for three cases:                                            *
+ *  -Adding a number of the same sign                                        *
+ *  -Adding a number of a different sign, greater magnitude                  *
+ *  -Adding a number of a different sign, lesser magnitude                   *
+ */
+BigInteger &BigInteger::operator+=(const BigInteger &rhs)
+{
+  if (isSmall() && rhs.isSmall()) {
+    unsigned long long a = getSmall();
+    unsigned long long b = rhs.getSmall();
+    if (negative == rhs.negative) {
+      uint128 sum = (uint128)a + b;
+      setWide((unsigned long long)sum, (unsigned long long)(sum >> 64));
+    } else if (b > a) {
+      negative = rhs.negative;
+      setSmall(b - a);
+    } else {
+      setSmall(a - b);
+    }
+    return *this;
+  }
+  if (negative == rhs.negative) {
+    addMagnitude(rhs);
+  } else if (compareMagnitude(rhs) >= 0) {
+    subtractMagnitude(rhs);
+  } else {
+    BigInteger temp(rhs);
+    temp.subtractMagnitude(*this);
+    swap(temp);
+  }
+  return *this;
+}
+
+
+/*  Subtraction is addition under negation:  a - b == -(-a + b).             *
+ *  Subtracting a number from itself must be handled separately, as flipping *
+ *    the sign of one side would flip the other.                             *
+ */
+BigInteger &BigInteger::operator-=(const BigInteger &rhs)
+{
+  if (this == &rhs) {
+    setSmall(0);
+    return *this;
+  }
+  negative = !negative;
+  operator+=(rhs);
+  if (size != 0) negative = !negative;
+  return *this;
+}
+
+
+/*  The following work directly on arrays of limbs, least significant first, *
+ *    for multiplication of large numbers.                                   *
+ *  Below this many limbs, the schoolbook method is faster than Karatsuba's. *
+ */
+static const int KARATSUBA_THRESHOLD = 32;
+
+
+/*  Adds x into r in place, carrying as far as needed within r's length.     *
+ */
+static void addLimbs(unsigned long long *r, int rLength,
+		     const unsigned long long *x, int xLength)
+{
+  unsigned long long carry = 0;
+  int i;
+  for (i = 0; i < xLength; i++) {
+    uint128 t = (uint128)r[i] + x[i] + carry;
+    r[i] = (unsigned long long)t;
+    carry = (unsigned long long)(t >> 64);
+  }
+  for (; carry != 0 && i < rLength; i++) {
+    carry = (++r[i] == 0);
+  }
+}
+
+
+/*  Subtracts x from r in place; r must be no smaller than x.                *
+ */
+static void subtractLimbs(unsigned long long *r, int rLength,
+			  const unsigned long long *x, int xLength)
+{
+  unsigned long long borrow = 0;
+  int i;
+  for (i = 0; i < xLength; i++) {
+    unsigned long long cur = r[i];
+    r[i] = cur - x[i] - borrow;
+    borrow = (cur < x[i]) || (cur - x[i] < borrow);
+  }
+  for (; borrow != 0 && i < rLength; i++) {
+    borrow = (r[i]-- == 0);
+  }
+}
+
+
+/*  Stores a * b in r, which must have room for aLength + bLength limbs and  *
+ *    must not overlap either operand.                                       *
+ *  Short operands use the schoolbook method.  Long ones of similar length   *
+ *    use Karatsuba's:  splitting each in two, at m limbs,                   *
+ *      a*b = z2*B^2m + z1*B^m + z0,  where                                  *
+ *      z0 = a0*b0,  z2 = a1*b1,  z1 = (a0 + a1)(b0 + b1) - z0 - z2          *
+ *    which needs three half-size products rather than four.  When one       *
+ *    operand is less than half the length of the other, the longer one is  *
+ *    instead cut into pieces the length of the shorter, each multiplied by  *
+ *    it in turn.                                                            *
+ */
+static void multiplyLimbs(const unsigned long long *a, int aLength,
+			  const unsigned long long *b, int bLength,
+			  unsigned long long *r)
+{
+  if (aLength < bLength) {
+    std::swap(a, b);
+    std::swap(aLength, bLength);
+  }
+  for (int i = 0; i < aLength + bLength; i++) {
+    r[i] = 0;
+  }
+  if (bLength < KARATSUBA_THRESHOLD) {
+    for (int i = 0; i < aLength; i++) {
+      unsigned long long carry = 0;
+      for (int j = 0; j < bLength; j++) {
+	uint128 t = (uint128)a[i] * b[j] + r[i + j] + carry;
+	r[i + j] = (unsigned long long)t;
+	carry = (unsigned long long)(t >> 64);
+      }
+      r[i + bLength] = carry;
+    }
+    return;
+  }
+  if (2 * bLength <= aLength) {
+    vector<unsigned long long> piece(2 * bLength);
+    for (int offset = 0; offset < aLength; offset += bLength) {
+      int length = min(bLength, aLength - offset);
+      multiplyLimbs(a + offset, length, b, bLength, &piece[0]);
+      addLimbs(r + offset, aLength + bLength - offset,
+	       &piece[0], length + bLength);
+    }
+    return;
+  }
+
+  int m = aLength / 2;
+  multiplyLimbs(a, m, b, m, r);
+  multiplyLimbs(a + m, aLength - m, b + m, bLength - m, r + 2 * m);
+
+  int aSumLength = max(m, aLength - m) + 1;
+  int bSumLength = max(m, bLength - m) + 1;
+  vector<unsigned long long> aSum(a, a + m);
+  vector<unsigned long long> bSum(b, b + m);
+  aSum.resize(aSumLength, 0);
+  bSum.resize(bSumLength, 0);
+  addLimbs(&aSum[0], aSumLength, a + m, aLength - m);
+  addLimbs(&bSum[0], bSumLength, b + m, bLength - m);
+  vector<unsigned long long> middle(aSumLength + bSumLength);
+  multiplyLimbs(&aSum[0], aSumLength, &bSum[0], bSumLength, &middle[0]);
+  subtractLimbs(&middle[0], middle.size(), r, 2 * m);
+  subtractLimbs(&middle[0], middle.size(), r + 2 * m,
+		aLength + bLength - 2 * m);
+  int middleLength = middle.size();
+  while (middleLength > 0 && middle[middleLength - 1] == 0) {
+    middleLength--;
+  }
+  addLimbs(r + m, aLength + bLength - m, &middle[0], middleLength);
+}
+
+
+/*  Two single-limb numbers multiply at 128 bits, and a single-limb side is  *
+ *    multiplied in place.  Anything larger goes to multiplyLimbs.           *
+ */
+BigInteger &BigInteger::operator*=(const BigInteger &rhs)
+{
+  bool productNegative = (negative != rhs.negative);
+  if (isSmall() && rhs.isSmall()) {
+    uint128 product = (uint128)getSmall() * rhs.getSmall();
+    setWide((unsigned long long)product, (unsigned long long)(product >> 64));
+  } else if (size == 0 || rhs.size == 0) {
+    setSmall(0);
+  } else if (rhs.size == 1) {
+    multiplySmall(rhs.getSmall(), 0);
+  } else if (size == 1) {
+    BigInteger result(rhs);
+    result.multiplySmall(getSmall(), 0);
+    swap(result);
+  } else {
+    BigInteger result;
+    result.reserve(size + rhs.size);
+    multiplyLimbs(data(), size, rhs.data(), rhs.size, result.data());
+    result.size = size + rhs.size;
+    result.trim();
+    swap(result);
+  }
+  negative = productNegative && size != 0;
+  return *this;
+}
+
+
+BigInteger &BigInteger::operator/=(const BigInteger &rhs)
+{
+  divide(*this, rhs, this, NULL);
+  return *this;
+}
+
+
+BigInteger &BigInteger::operator%=(const BigInteger &rhs)
+{
+  divide(*this, rhs, NULL, this);
+  return *this;
+}
+
+
+BigInteger &BigInteger::operator<<=(unsigned bits)
+{
+  if (size == 0 || bits == 0) return *this;
+  int limbShift = bits / 64;
+  unsigned bitShift = bits % 64;
+  reserve(size + limbShift + 1);
+  unsigned long long *d = data();
+  d[size + limbShift] = 0;
+  for (int i = size - 1; i >= 0; i--) {
+    if (bitShift != 0) {
+      d[i + limbShift + 1] |= d[i] >> (64 - bitShift);
+    }
+    d[i + limbShift] = d[i] << bitShift;
+  }
+  for (int i = 0; i < limbShift; i++) {
+    d[i] = 0;
+  }
+  size += limbShift + 1;
+  trim();
+  return *this;
+}
+
+
+BigInteger &BigInteger::operator>>=(unsigned bits)
+{
+  int limbShift = bits / 64;
+  unsigned bitShift = bits % 64;
+  if (limbShift >= size) {
+    setSmall(0);
+    return *this;
+  }
+  unsigned long long *d = data();
+  for (int i = 0; i < size - limbShift; i++) {
+    d[i] = d[i + limbShift] >> bitShift;
+    if (bitShift != 0 && i + limbShift + 1 < size) {
+      d[i] |= d[i + limbShift + 1] << (64 - bitShift);
+    }
+  }
+  size -= limbShift;
+  trim();
+  return *this;
+}
+
+
+/*  Three cases, from cheapest to most expensive:                            *
+ *  -Both numbers fit in a limb, so built-in division does the work.         *
+ *  -The divisor fits in a limb, so one pass of short division does.         *
+ *  -Otherwise, long division, by Knuth's Algorithm D (TAOCP vol. 2, 4.3.1). *
+ *     Both numbers are shifted so that the divisor's top bit is set, which  *
+ *     makes each estimated quotient limb at most two too large.             *
+ *  Results are built in locals and only stored at the end, so that the      *
+ *    destinations may be the same objects as the operands.                  *
+ */
+void BigInteger::divide(const BigInteger &dividend, const BigInteger &divisor,
+			BigInteger *quotient, BigInteger *remainder)
+{
+  if (divisor.size == 0) return;
+  bool quotientNegative = (dividend.negative != divisor.negative);
+  bool remainderNegative = dividend.negative;
+  BigInteger quot;
+  BigInteger rem;
+  if (dividend.compareMagnitude(divisor) < 0) {
+    rem = dividend;
+  } else if (dividend.isSmall()) {
+    quot.setSmall(dividend.getSmall() / divisor.getSmall());
+    rem.setSmall(dividend.getSmall() % divisor.getSmall());
+  } else if (divisor.isSmall()) {
+    quot = dividend;
+    rem.setSmall(quot.divideSmall(divisor.getSmall()));
+  } else {
+    int n = divisor.size;
+    int m = dividend.size - n;
+    const unsigned long long *u = dividend.data();
+    const unsigned long long *v = divisor.data();
+    int s = __builtin_clzll(v[n - 1]);
+    unsigned long long *vn = new unsigned long long[n];
+    unsigned long long *un = new unsigned long long[m + n + 1];
+    for (int i = n - 1; i > 0; i--) {
+      vn[i] = (v[i] << s) | (s ? v[i - 1] >> (64 - s) : 0);
+    }
+    vn[0] = v[0] << s;
+    un[m + n] = s ? u[m + n - 1] >> (64 - s) : 0;
+    for (int i = m + n - 1; i > 0; i--) {
+      un[i] = (u[i] << s) | (s ? u[i - 1] >> (64 - s) : 0);
+    }
+    un[0] = u[0] << s;
+
+    quot.reserve(m + 1);
+    unsigned long long *q = quot.data();
+    for (int j = m; j >= 0; j--) {
+      /* Estimate the quotient limb from the top two limbs, then refine it */
+      uint128 top = ((uint128)un[j + n] << 64) | un[j + n - 1];
+      uint128 qhat = top / vn[n - 1];
+      uint128 rhat = top - qhat * vn[n - 1];
+      while ((qhat >> 64) != 0 ||
+	     qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2])) {
+	qhat--;
+	rhat += vn[n - 1];
+	if ((rhat >> 64) != 0) break;
+      }
+
+      /* Multiply and subtract */
+      unsigned long long borrow = 0;
+      unsigned long long carry = 0;
+      for (int i = 0; i < n; i++) {
+	uint128 p = qhat * vn[i] + carry;
+	carry = (unsigned long long)(p >> 64);
+	unsigned long long low = (unsigned long long)p;
+	unsigned long long cur = un[i + j];
+	un[i + j] = cur - low - borrow;
+	borrow = (cur < low) || (cur - low < borrow);
+      }
+      unsigned long long cur = un[j + n];
+      un[j + n] = cur - carry - borrow;
+      bool overshot = (cur < carry) || (cur - carry < borrow);
+
+      /* The estimate was one too large, so add one divisor back */
+      if (overshot) {
+	qhat--;
+	unsigned long long c = 0;
+	for (int i = 0; i < n; i++) {
+	  uint128 t = (uint128)un[i + j] + vn[i] + c;
+	  un[i + j] = (unsigned long long)t;
+	  c = (unsigned long long)(t >> 64);
+	}
+	un[j + n] += c;
+      }
+      q[j] = (unsigned long long)qhat;
+    }
+    quot.size = m + 1;
+    quot.trim();
+
+    rem.reserve(n);
+    unsigned long long *r = rem.data();
+    for (int i = 0; i < n; i++) {
+      r[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+    }
+    rem.size = n;
+    rem.trim();
+    delete [] vn;
+    delete [] un;
+  }
+  quot.negative = quotientNegative && quot.size != 0;
+  rem.negative = remainderNegative && rem.size != 0;
+  if (quotient != NULL) quotient->swap(quot);
+  if (remainder != NULL) remainder->swap(rem);
+}
+
+
+int BigInteger::compare(const BigInteger &rhs) const
+{
+  if (negative != rhs.negative) return negative ? -1 : 1;
+  int result = compareMagnitude(rhs);
+  return negative ? -result : result;
+}
+
+
+BigInteger BigInteger::power(unsigned exp) const
+{
+  BigInteger result(1);
+  BigInteger base(*this);
+  while (exp > 0) {
+    if (exp & 1) result *= base;
+    exp >>= 1;
+    if (exp > 0) base *= base;
+  }
+  return result;
+}
+
+
+/*  Uses Newton's method, starting from a power of two no smaller than the   *
+ *    root; the iterates then decrease monotonically to the floor of the     *
+ *    root.  Single-limb numbers start from the floating-point root instead, *
+ *    which needs at most a step of correction either way.                   *
+ */
+BigInteger BigInteger::squareRoot() const
+{
+  if (size == 0) return BigInteger();
+  if (size == 1) {
+    unsigned long long n = getSmall();
+    unsigned long long root = (unsigned long long)sqrt((double)n);
+    while (root > 0 && (uint128)root * root > n) root--;
+    while ((uint128)(root + 1) * (root + 1) <= n) root++;
+    return BigInteger(root, false);
+  }
+  BigInteger magnitude(*this);
+  magnitude.negative = false;
+  BigInteger root(1);
+  root <<= (magnitude.bitLength() + 1) / 2;
+  while (true) {
+    BigInteger next = magnitude / root;
+    next += root;
+    next >>= 1;
+    if (next.compareMagnitude(root) >= 0) break;
+    root.swap(next);
+  }
+  return root;
+}
+
+
+double BigInteger::toDouble() const
+{
+  if (size == 0) return 0;
+  const unsigned long long *d = data();
+  double result = ldexp((double)d[size - 1], 64 * (size - 1));
+  if (size > 1) result += ldexp((double)d[size - 2], 64 * (size - 2));
+  return negative ? -result : result;
+}
+
+
+/*  Peels off chunks of decimal digits from the bottom, by repeated short    *
+ *    division, then writes them out from the top.  Every chunk but the      *
+ *    first is padded with zeros to its full width.                          *
+ */
+string BigInteger::toString() const
+{
+  if (size == 0) return "0";
+  string result = negative ? "-" : "";
+  if (size == 1) return result + to_string(getSmall());
+  BigInteger rest(*this);
+  vector<unsigned long long> chunks;
+  while (rest.size != 0) {
+    chunks.push_back(rest.divideSmall(CHUNK));
+  }
+  result += to_string(chunks.back());
+  for (int i = chunks.size() - 2; i >= 0; i--) {
+    string chunk = to_string(chunks[i]);
+    result.append(CHUNK_DIGITS - chunk.size(), '0');
+    result += chunk;
+  }
+  return result;
+}
+
+
+unsigned BigInteger::length() const
+{
+  if (size > 1) return toString().size();
+  unsigned len = negative ? 2 : 1;
+  for (unsigned long long x = getSmall(); x >= 10; x /= 10) {
+    len++;
+  }
+  return len;
+}
+
+
+void BigInteger::print(ostream &stream) const
+{
+  if (size <= 1) {
+    stream << (negative ? "-" : "") << getSmall();
+  } else {
+    stream << toString();
+  }
+}
+
+
+unsigned long long *BigInteger::data()
+{
+  return (limbs != NULL) ? limbs : &small;
+}
+
+
+const unsigned long long *BigInteger::data() const
+{
+  return (limbs != NULL) ? limbs : &small;
+}
+
+
+/*  Makes room for at least the given number of limbs, keeping the current   *
+ *    magnitude.  Moves the number onto the heap the first time it needs     *
+ *    more than one limb, and at least doubles the space each time after.    *
+ */
+void BigInteger::reserve(int count)
+{
+  if (count <= 1 && limbs == NULL) return;
+  if (count <= capacity) return;
+  int newCapacity = (2 * capacity > count) ? 2 * capacity : count;
+  if (newCapacity < 4) newCapacity = 4;
+  unsigned long long *newLimbs = new unsigned long long[newCapacity];
+  const unsigned long long *old = data();
+  for (int i = 0; i < size; i++) {
+    newLimbs[i] = old[i];
+  }
+  delete [] limbs;
+  limbs = newLimbs;
+  capacity = newCapacity;
+}
+
+
+/*  Drops leading zero limbs.  Zero is never negative.                       *
+ */
+void BigInteger::trim()
+{
+  const unsigned long long *d = data();
+  while (size > 0 && d[size - 1] == 0) {
+    size--;
+  }
+  if (size == 0) negative = false;
+}
+
+
+void BigInteger::setSmall(unsigned long long magnitude)
+{
+  data()[0] = magnitude;
+  size = (magnitude != 0);
+  if (size == 0) negative = false;
+}
+
+
+void BigInteger::setWide(unsigned long long low, unsigned long long high)
+{
+  if (high == 0) {
+    setSmall(low);
+    return;
+  }
+  reserve(2);
+  unsigned long long *d = data();
+  d[0] = low;
+  d[1] = high;
+  size = 2;
+}
+
+
+int BigInteger::compareMagnitude(const BigInteger &rhs) const
+{
+  if (size != rhs.size) return (size < rhs.size) ? -1 : 1;
+  const unsigned long long *a = data();
+  const unsigned long long *b = rhs.data();
+  for (int i = size - 1; i >= 0; i--) {
+    if (a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+  }
+  return 0;
+}
+
+
+/*  Adds the magnitude of rhs to this one, ignoring signs.                   *
+ *  rhs may be this same object.                                             *
+ */
+void BigInteger::addMagnitude(const BigInteger &rhs)
+{
+  int n = (size > rhs.size) ? size : rhs.size;
+  reserve(n + 1);
+  unsigned long long *d = data();
+  const unsigned long long *r = rhs.data();
+  for (int i = size; i < n; i++) {
+    d[i] = 0;
+  }
+  unsigned long long carry = 0;
+  for (int i = 0; i < n; i++) {
+    uint128 t = (uint128)d[i] + (i < rhs.size ? r[i] : 0) + carry;
+    d[i] = (unsigned long long)t;
+    carry = (unsigned long long)(t >> 64);
+  }
+  d[n] = carry;
+  size = n + (carry != 0);
+}
+
+
+/*  Subtracts the magnitude of rhs from this one, ignoring signs.            *
+ *  The magnitude of rhs must be no greater than this one.                   *
+ */
+void BigInteger::subtractMagnitude(const BigInteger &rhs)
+{
+  unsigned long long *d = data();
+  const unsigned long long *r = rhs.data();
+  unsigned long long borrow = 0;
+  for (int i = 0; i < size; i++) {
+    unsigned long long sub = (i < rhs.size) ? r[i] : 0;
+    unsigned long long cur = d[i];
+    d[i] = cur - sub - borrow;
+    borrow = (cur < sub) || (cur - sub < borrow);
+    if (i >= rhs.size && borrow == 0) break;
+  }
+  trim();
+}
+
+
+/*  Sets the magnitude to (magnitude * factor + addend), in place.           *
+ */
+void BigInteger::multiplySmall(unsigned long long factor,
+			       unsigned long long addend)
+{
+  unsigned long long *d = data();
+  unsigned long long carry = addend;
+  for (int i = 0; i < size; i++) {
+    uint128 t = (uint128)d[i] * factor + carry;
+    d[i] = (unsigned long long)t;
+    carry = (unsigned long long)(t >> 64);
+  }
+  if (carry != 0) {
+    reserve(size + 1);
+    data()[size++] = carry;
+  }
+  trim();
+}
+
+
+/*  Divides the magnitude by the divisor in place, returning the remainder.  *
+ */
+unsigned long long BigInteger::divideSmall(unsigned long long divisor)
+{
+  unsigned long long *d = data();
+  unsigned long long rem = 0;
+  for (int i = size - 1; i >= 0; i--) {
+    uint128 cur = ((uint128)rem << 64) | d[i];
+    d[i] = (unsigned long long)(cur / divisor);
+    rem = (unsigned long long)(cur % divisor);
+  }
+  trim();
+  return rem;
+}
+
+
+/*  Returns the Greatest Common Divisor of two single-limb numbers, by the   *
+ *    binary algorithm; see Fraction::GCD.                                   *
+ */
+static unsigned long long smallGCD(unsigned long long num1,
+				   unsigned long long num2)
+{
+  if (num1 == 0) return num2;
+  if (num2 == 0) return num1;
+  int shift = __builtin_ctzll(num1 | num2);
+  num1 >>= __builtin_ctzll(num1);
+  do {
+    num2 >>= __builtin_ctzll(num2);
+    unsigned long long smaller = (num1 < num2) ? num1 : num2;
+    num2 = (num1 < num2 ? num2 : num1) - smaller;
+    num1 = smaller;
+  } while (num2 != 0);
+  return num1 << shift;
+}
+
+
+/*  Utilizes the Euclidean algorithm until both numbers fit in a limb, then  *
+ *    finishes with the binary algorithm.                                    *
+ */
+BigInteger GCD(const BigInteger &num1, const BigInteger &num2)
+{
+  BigInteger a = num1.isNegative() ? -num1 : num1;
+  BigInteger b = num2.isNegative() ? -num2 : num2;
+  while (!b.isZero()) {
+    if (a.isSmall() && b.isSmall()) {
+      return BigInteger(smallGCD(a.getSmall(), b.getSmall()), false);
+    }
+    a %= b;
+    a.swap(b);
+  }
+  return a;
+}
+
+
+/*  The factorials that fit in a single limb.                                *
+ */
+static const unsigned long long SMALL_FACTORIALS[] = {
+  1ULL, 1ULL, 2ULL, 6ULL, 24ULL, 120ULL, 720ULL, 5040ULL, 40320ULL,
+  362880ULL, 3628800ULL, 39916800ULL, 479001600ULL, 6227020800ULL,
+  87178291200ULL, 1307674368000ULL, 20922789888000ULL, 355687428096000ULL,
+  6402373705728000ULL, 121645100408832000ULL, 2432902008176640000ULL
+};
+static const unsigned SMALL_FACTORIAL_COUNT = 21;
+
+
+/*  Returns the product of the odd numbers in the range (low, high].         *
+ *  Short ranges are multiplied out a limb at a time.  Longer ones are split *
+ *    in half, each half multiplied out, and the two results multiplied, so  *
+ *    that every multiplication is between numbers of about the same size.  *
+ */
+static BigInteger oddProduct(unsigned long long low, unsigned long long high)
+{
+  unsigned long long first = (low + 1) | 1;
+  if (first > high) return BigInteger(1);
+  unsigned long long count = (high - first) / 2 + 1;
+  if (count <= 16) {
+    BigInteger result(1);
+    unsigned long long product = 1;
+    for (unsigned long long odd = first; odd <= high; odd += 2) {
+      uint128 wide = (uint128)product * odd;
+      if ((wide >> 64) != 0) {
+	result *= BigInteger(product, false);
+	product = odd;
+      } else {
+	product = (unsigned long long)wide;
+      }
+    }
+    result *= BigInteger(product, false);
+    return result;
+  }
+  unsigned long long middle = first + 2 * (count / 2) - 1;
+  BigInteger result = oddProduct(low, middle);
+  result *= oddProduct(middle, high);
+  return result;
+}
+
+
+/*  Every number m <= n is (2^i * o) for some odd o <= n / 2^i, so the odd   *
+ *    part of n! is the product, over all i, of the odd numbers up to        *
+ *    n / 2^i.  Working from the largest i down, each of those products      *
+ *    extends the previous one by a range of new odd numbers.  The factors   *
+ *    of two, of which n! has (n - the number of 1 bits in n), are shifted   *
+ *    in at the end.                                                         *
+ */
+BigInteger factorial(unsigned n)
+{
+  if (n < SMALL_FACTORIAL_COUNT) {
+    return BigInteger(SMALL_FACTORIALS[n], false);
+  }
+  BigInteger result(1);
+  BigInteger oddFactorial(1);
+  unsigned long long low = 1;
+  for (int i = 31 - __builtin_clz(n); i >= 0; i--) {
+    unsigned long long high = n >> i;
+    oddFactorial *= oddProduct(low, high);
+    low = high;
+    result *= oddFactorial;
+  }
+  result <<= n - __builtin_popcount(n);
+  return result;
+}
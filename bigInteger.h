@@ -0,0 +1,210 @@
+/*---------------------------------------------------------------------------*\
+ *                               bigInteger.h                                *
+ *                     Interface for the BigInteger class                    *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Represents an integer of any size, exactly.                            *
+ *    Numbers are represented as (sign) (magnitude), where the magnitude is  *
+ *      a sequence of 64-bit "limbs", least significant first.               *
+ *    Used as the numerator and denominator of a BigRational, and anywhere   *
+ *      else an exact result may not fit in a long long.                     *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -A magnitude that fits in a single limb is stored inline, within the    *
+ *      object itself.  Heap space is only allocated once a number grows     *
+ *      past 64 bits, so small numbers cost about as much as a long long.    *
+ *   -Operations on two inline numbers take a fast path using 128-bit       *
+ *      arithmetic, falling back to the general routines only when the       *
+ *      result does not fit in a single limb.                                *
+ *   -Division truncates toward zero, and the remainder takes the sign of    *
+ *      the dividend, as with built-in integers.  Division by zero leaves    *
+ *      the number unchanged.                                                *
+\*---------------------------------------------------------------------------*/
+#ifndef BIGINTEGER_CLASS_INCLUDED
+#define BIGINTEGER_CLASS_INCLUDED
+#include<iostream>
+#include<string>
+using namespace std;
+
+class BigInteger
+{
+ public:
+  /*  Constructors                                                           *
+   *  Default constructor initializes the number to zero.                    *
+   *  Second constructor initializes to the given integer.                   *
+   *  Third constructor initializes to a magnitude and sign; useful for      *
+   *    values above LLONG_MAX.                                              *
+   *  Fourth constructor reads a string of decimal digits, with an optional  *
+   *    leading '-'.  Reading stops at the first non-digit.                  *
+   */
+  BigInteger();
+  BigInteger(long long number);
+  BigInteger(unsigned long long magnitude, bool negative);
+  BigInteger(const string &digits);
+
+  BigInteger(const BigInteger &rval);
+  BigInteger &operator=(const BigInteger &rval);
+  ~BigInteger();
+
+  /*  Exchanges the contents of two numbers without copying any limbs.       *
+   */
+  void swap(BigInteger &other);
+
+  bool isZero() const;
+  bool isNegative() const;
+
+  /*  Whether the magnitude fits in a single 64-bit word, and that word.     *
+   */
+  bool isSmall() const;
+  unsigned long long getSmall() const;
+
+  /*  Returns the number of significant bits in the magnitude.               *
+   */
+  unsigned bitLength() const;
+
+  /*  Arithmetic follows the usual rules for integers.                       *
+   *  Non-assigning arithmetic operators are defined below the class.        *
+   */
+  BigInteger operator-() const;
+  BigInteger &operator+=(const BigInteger &rhs);
+  BigInteger &operator-=(const BigInteger &rhs);
+  BigInteger &operator*=(const BigInteger &rhs);
+  BigInteger &operator/=(const BigInteger &rhs);
+  BigInteger &operator%=(const BigInteger &rhs);
+
+  /*  Shifts the magnitude by the given number of bits.                      *
+   */
+  BigInteger &operator<<=(unsigned bits);
+  BigInteger &operator>>=(unsigned bits);
+
+  /*  Computes both quotient and remainder of a division at once.  Either    *
+   *    destination may be NULL if it is not wanted.  Division by zero       *
+   *    leaves the destinations unchanged.                                   *
+   */
+  static void divide(const BigInteger &dividend, const BigInteger &divisor,
+                     BigInteger *quotient, BigInteger *remainder);
+
+  /*  Returns a negative number, zero, or a positive number as this is less  *
+   *    than, equal to, or greater than rhs.                                 *
+   */
+  int compare(const BigInteger &rhs) const;
+
+  /*  Returns the number raised to the given power, by repeated squaring.    *
+   */
+  BigInteger power(unsigned exp) const;
+
+  /*  Returns the floor of the square root of the magnitude.                 *
+   */
+  BigInteger squareRoot() const;
+
+  /*  Conversions.  toDouble() rounds, and may be infinite.                  *
+   */
+  double toDouble() const;
+  string toString() const;
+
+  /*  Returns the number of characters that the number will take up when    *
+   *    printed, including a '-' if it is negative.                          *
+   */
+  unsigned length() const;
+
+  void print(ostream &stream) const;
+
+ private:
+  bool negative;
+  int size;                     /* Limbs in use; 0 for the number zero     */
+  int capacity;                 /* Heap limbs allocated; 0 while inline    */
+  unsigned long long small;     /* The magnitude, while it is inline       */
+  unsigned long long *limbs;    /* The magnitude, once it is on the heap   */
+
+  unsigned long long *data();
+  const unsigned long long *data() const;
+  void reserve(int count);
+  void trim();
+  void setSmall(unsigned long long magnitude);
+  void setWide(unsigned long long low, unsigned long long high);
+
+  int compareMagnitude(const BigInteger &rhs) const;
+  void addMagnitude(const BigInteger &rhs);
+  void subtractMagnitude(const BigInteger &rhs);
+  void multiplySmall(unsigned long long factor, unsigned long long addend);
+  unsigned long long divideSmall(unsigned long long divisor);
+};
+
+
+/*  Returns the Greatest Common Divisor of two numbers, which is never       *
+ *    negative.  GCD(0, x) is |x|.                                           *
+ */
+BigInteger GCD(const BigInteger &num1, const BigInteger &num2);
+
+
+/*  Returns n!, exactly.  Small factorials come from a table; the rest are   *
+ *    built by binary splitting, which keeps the factors of each             *
+ *    multiplication balanced in size.                                       *
+ */
+BigInteger factorial(unsigned n);
+
+
+/*  The following define further arithmetic and comparison operators in     *
+ *    terms of the ones already declared within the class.                   *
+ */
+inline BigInteger operator+(BigInteger lhs, const BigInteger &rhs)
+{
+  lhs += rhs;
+  return lhs;
+}
+
+inline BigInteger operator-(BigInteger lhs, const BigInteger &rhs)
+{
+  lhs -= rhs;
+  return lhs;
+}
+
+inline BigInteger operator*(BigInteger lhs, const BigInteger &rhs)
+{
+  lhs *= rhs;
+  return lhs;
+}
+
+inline BigInteger operator/(BigInteger lhs, const BigInteger &rhs)
+{
+  lhs /= rhs;
+  return lhs;
+}
+
+inline BigInteger operator%(BigInteger lhs, const BigInteger &rhs)
+{
+  lhs %= rhs;
+  return lhs;
+}
+
+inline bool operator==(const BigInteger &lhs, const BigInteger &rhs)
+{
+  return lhs.compare(rhs) == 0;
+}
+
+inline bool operator!=(const BigInteger &lhs, const BigInteger &rhs)
+{
+  return lhs.compare(rhs) != 0;
+}
+
+inline bool operator<(const BigInteger &lhs, const BigInteger &rhs)
+{
+  return lhs.compare(rhs) < 0;
+}
+
+inline bool operator>(const BigInteger &lhs, const BigInteger &rhs)
+{
+  return lhs.compare(rhs) > 0;
+}
+
+inline bool operator<=(const BigInteger &lhs, const BigInteger &rhs)
+{
+  return lhs.compare(rhs) <= 0;
+}
+
+inline bool operator>=(const BigInteger &lhs, const BigInteger &rhs)
+{
+  return lhs.compare(rhs) >= 0;
+}
+
+#endif
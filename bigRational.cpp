@@ -0,0 +1,559 @@
+/*---------------------------------------------------------------------------*\
+ *                              bigRational.cpp                              *
+ *                   Implementation of the BigRational class                 *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    The sign is carried by the numerator; the denominator is positive, or  *
+ *    zero for nan.  Every operation first tries the small path: if both     *
+ *    operands fit in a Fraction, the Fraction class does the arithmetic,    *
+ *    and its result is kept unless it overflowed.  Only then is the big     *
+ *    path, written in terms of BigInteger, taken.                           *
+\*---------------------------------------------------------------------------*/
+#include<iostream>
+#include<string>
+#include<math.h>
+#include "fraction.h"
+#include "bigInteger.h"
+#include "bigRational.h"
+using namespace std;
+
+typedef unsigned __int128 uint128;
+
+
+BigRational::BigRational() : numerator(), denominator(1)
+{
+}
+
+
+BigRational::BigRational(long long number) : numerator(number), denominator(1)
+{
+}
+
+
+BigRational::BigRational(long long numerator, long long denominator)
+{
+  setSmall(Fraction(numerator, denominator));
+}
+
+
+BigRational::BigRational(Fraction value)
+{
+  setSmall(value);
+}
+
+
+BigRational::BigRational(const BigInteger &number)
+  : numerator(number), denominator(1)
+{
+}
+
+
+/*  Sets the number to (numerator/denominator), properly reduced.            *
+ */
+BigRational::BigRational(const BigInteger &numerator,
+			 const BigInteger &denominator)
+  : numerator(numerator), denominator(denominator)
+{
+  if (denominator.isZero()) {
+    setNan();
+    return;
+  }
+  BigInteger divisor = GCD(numerator, denominator);
+  if (denominator.isNegative()) divisor = -divisor;
+  if (divisor != 1) {
+    this->numerator /= divisor;
+    this->denominator /= divisor;
+  }
+}
+
+
+const BigInteger &BigRational::getNumerator() const
+{
+  return numerator;
+}
+
+
+const BigInteger &BigRational::getDenominator() const
+{
+  return denominator;
+}
+
+
+bool BigRational::isNegative() const
+{
+  return numerator.isNegative() && !isNan();
+}
+
+
+bool BigRational::isNan() const
+{
+  return denominator.isZero();
+}
+
+
+bool BigRational::isInteger() const
+{
+  return denominator.isSmall() && denominator.getSmall() == 1;
+}
+
+
+bool BigRational::fitsFraction() const
+{
+  return numerator.isSmall() && denominator.isSmall() &&
+    denominator.getSmall() <= Fraction::MAX_DENOMINATOR;
+}
+
+
+Fraction BigRational::toFraction() const
+{
+  Fraction result(1, 0);
+  toSmall(&result);
+  return result;
+}
+
+
+/*  Scales both terms down to their top 64 bits before dividing, so that     *
+ *    numbers too large for a double on their own still divide correctly.   *
+ */
+double BigRational::toDouble() const
+{
+  if (isNan()) return NAN;
+  int numShift = numerator.bitLength() - 64;
+  int denShift = denominator.bitLength() - 64;
+  if (numShift < 0) numShift = 0;
+  if (denShift < 0) denShift = 0;
+  BigInteger num = numerator;
+  BigInteger den = denominator;
+  num >>= numShift;
+  den >>= denShift;
+  return ldexp(num.toDouble() / den.toDouble(), numShift - denShift);
+}
+
+
+BigRational &BigRational::operator=(long long rhs)
+{
+  numerator = rhs;
+  denominator = 1;
+  return *this;
+}
+
+
+BigRational BigRational::operator-() const
+{
+  BigRational result(*this);
+  result.numerator = -numerator;
+  return result;
+}
+
+
+/*  The big path reduces each numerator against the other denominator first;*
+ *    the product is then in lowest terms, as in Fraction::operator*=.       *
+ */
+BigRational &BigRational::operator*=(const BigRational &rhs)
+{
+  Fraction lhsSmall, rhsSmall;
+  if (toSmall(&lhsSmall) && rhs.toSmall(&rhsSmall)) {
+    lhsSmall *= rhsSmall;
+    if (!lhsSmall.isNan() || isNan() || rhs.isNan()) {
+      setSmall(lhsSmall);
+      return *this;
+    }
+  }
+  if (isNan() || rhs.isNan()) {
+    setNan();
+    return *this;
+  }
+  BigInteger lhsCommon = GCD(numerator, rhs.denominator);
+  BigInteger rhsCommon = GCD(rhs.numerator, denominator);
+  BigInteger num = (numerator / lhsCommon) * (rhs.numerator / rhsCommon);
+  BigInteger den = (denominator / rhsCommon) * (rhs.denominator / lhsCommon);
+  numerator.swap(num);
+  denominator.swap(den);
+  return *this;
+}
+
+
+BigRational &BigRational::operator/=(const BigRational &rhs)
+{
+  if (rhs.numerator.isZero()) {
+    setNan();
+    return *this;
+  }
+  return operator*=(rhs.reciprocal());
+}
+
+
+/*  The big path uses the same method as Fraction::operator+=, from Knuth:   *
+ *    with g = GCD(b, d), only factors of g can be common to the sum and     *
+ *    the denominator (b/g) * d.                                             *
+ */
+BigRational &BigRational::operator+=(const BigRational &rhs)
+{
+  Fraction lhsSmall, rhsSmall;
+  if (toSmall(&lhsSmall) && rhs.toSmall(&rhsSmall)) {
+    lhsSmall += rhsSmall;
+    if (!lhsSmall.isNan() || isNan() || rhs.isNan()) {
+      setSmall(lhsSmall);
+      return *this;
+    }
+  }
+  if (isNan() || rhs.isNan()) {
+    setNan();
+    return *this;
+  }
+  BigInteger g = GCD(denominator, rhs.denominator);
+  BigInteger lhsScale = rhs.denominator / g;
+  BigInteger rhsScale = denominator / g;
+  BigInteger sum = numerator * lhsScale + rhs.numerator * rhsScale;
+  BigInteger common = GCD(sum, g);
+  if (common != 1) sum /= common;
+  BigInteger den = rhsScale * (rhs.denominator / common);
+  if (sum.isZero()) den = 1;
+  numerator.swap(sum);
+  denominator.swap(den);
+  return *this;
+}
+
+
+BigRational &BigRational::operator-=(const BigRational &rhs)
+{
+  return operator+=(-rhs);
+}
+
+
+/*  Both numbers are in lowest terms, so equal numbers have equal terms.     *
+ */
+bool BigRational::operator==(const BigRational &rhs) const
+{
+  return numerator == rhs.numerator && denominator == rhs.denominator;
+}
+
+
+/*  Compares a/b < c/d as a*d < c*b, which holds since b and d are positive. *
+ *  Small numbers differing in sign need no multiplication at all; the rest  *
+ *    are cross-multiplied at 128 bits.                                      *
+ */
+bool BigRational::operator<(const BigRational &rhs) const
+{
+  if (isNan() || rhs.isNan()) return false;
+  if (fitsFraction() && rhs.fitsFraction()) {
+    bool lhsNegative = numerator.isNegative();
+    bool rhsNegative = rhs.numerator.isNegative();
+    if (lhsNegative != rhsNegative) return lhsNegative;
+    uint128 lhsCross = (uint128)numerator.getSmall() *
+      rhs.denominator.getSmall();
+    uint128 rhsCross = (uint128)rhs.numerator.getSmall() *
+      denominator.getSmall();
+    return lhsNegative ? (rhsCross < lhsCross) : (lhsCross < rhsCross);
+  }
+  return numerator * rhs.denominator < rhs.numerator * denominator;
+}
+
+
+BigRational BigRational::sqroot() const
+{
+  return sqroot(BigInteger(Fraction::DEFAULT_ROOT_PRECISION, false));
+}
+
+
+/*  Works exactly as Fraction::sqroot(precision) does, with BigIntegers in   *
+ *    place of 128-bit integers, so the convergents never need to stop short *
+ *    of the requested precision.                                            *
+ */
+BigRational BigRational::sqroot(const BigInteger &precision) const
+{
+  BigRational result;
+  if (isNegative() || isNan()) {
+    result.setNan();
+    return result;
+  }
+  BigInteger numRoot = numerator.squareRoot();
+  BigInteger denRoot = denominator.squareRoot();
+  if (numRoot * numRoot == numerator && denRoot * denRoot == denominator) {
+    result.numerator.swap(numRoot);
+    result.denominator.swap(denRoot);
+    return result;
+  }
+
+  BigInteger n = numerator * denominator;
+  BigInteger root = n.squareRoot();
+  BigInteger p = 0;
+  BigInteger q = denominator;
+  BigInteger a = root / q;
+  BigInteger h = a, hPrev = 1;        /* Convergent numerators   */
+  BigInteger k = 1, kPrev = 0;        /* Convergent denominators */
+  while (true) {
+    p = a * q - p;
+    q = (n - p * p) / q;
+    a = (root + p) / q;
+    BigInteger kNext = a * k + kPrev;
+    if (k * kNext >= precision) break;
+    BigInteger hNext = a * h + hPrev;
+    hPrev.swap(h);
+    h.swap(hNext);
+    kPrev.swap(k);
+    k.swap(kNext);
+  }
+  result.numerator.swap(h);
+  result.denominator.swap(k);
+  return result;
+}
+
+
+/*  Follows Fraction::limitDenominator, with BigIntegers, unless both the    *
+ *    number and the limit are small enough for the Fraction itself.         *
+ */
+BigRational BigRational::limitDenominator(const BigInteger &limit) const
+{
+  BigRational result;
+  if (isNan() || limit.isNegative() || limit.isZero()) {
+    result.setNan();
+    return result;
+  }
+  if (denominator <= limit) return *this;
+  Fraction small;
+  if (limit.isSmall() && toSmall(&small)) {
+    result.setSmall(small.limitDenominator(limit.getSmall()));
+    return result;
+  }
+
+  BigInteger n = numerator;
+  if (n.isNegative()) n = -n;
+  const BigInteger &d = denominator;
+  BigInteger p = 1, pPrev = 0;
+  BigInteger q = 0, qPrev = 1;
+  BigInteger num = n, den = d;
+  while (true) {
+    BigInteger a, remainder;
+    BigInteger::divide(num, den, &a, &remainder);
+    BigInteger qNext = a * q + qPrev;
+    if (qNext > limit) break;
+    BigInteger pNext = a * p + pPrev;
+    pPrev.swap(p);
+    p.swap(pNext);
+    qPrev.swap(q);
+    q.swap(qNext);
+    num.swap(den);
+    den.swap(remainder);
+  }
+  BigInteger k = (limit - qPrev) / q;
+  BigInteger semiNum = pPrev + k * p;
+  BigInteger semiDen = qPrev + k * q;
+  BigInteger convergentDistance = p * d - n * q;
+  BigInteger semiDistance = semiNum * d - n * semiDen;
+  if (convergentDistance.isNegative()) convergentDistance = -convergentDistance;
+  if (semiDistance.isNegative()) semiDistance = -semiDistance;
+  convergentDistance *= semiDen;
+  semiDistance *= q;
+  if (convergentDistance < semiDistance ||
+      (convergentDistance == semiDistance && q < semiDen)) {
+    result.numerator.swap(p);
+    result.denominator.swap(q);
+  } else {
+    result.numerator.swap(semiNum);
+    result.denominator.swap(semiDen);
+  }
+  if (numerator.isNegative()) result.numerator = -result.numerator;
+  return result;
+}
+
+
+/*  Finds the simplest number in [low, high] from the continued fractions of *
+ *    its ends.  If the interval holds an integer, the smallest one is the   *
+ *    answer.  Otherwise both ends share an integer part a, and the answer   *
+ *    is a + 1/x, for x the simplest number in [1/(high - a), 1/(low - a)].  *
+ *  Each such a is a term of the answer's continued fraction, folded into    *
+ *    the convergents p/q as it is found, so no recursion is needed.         *
+ *  An interval around zero gives zero; one below zero is handled as its     *
+ *    mirror image.                                                          *
+ */
+BigRational BigRational::simplest(const BigRational &tolerance) const
+{
+  BigRational result;
+  if (isNan() || tolerance.isNan() || tolerance.isNegative()) {
+    result.setNan();
+    return result;
+  }
+  BigRational low = *this - tolerance;
+  BigRational high = *this + tolerance;
+  if (!high.isNegative() && (low.isNegative() || low.numerator.isZero())) {
+    return result;
+  }
+  bool negative = high.isNegative();
+  if (negative) {
+    BigRational mirror = -high;
+    high = -low;
+    low = mirror;
+  }
+
+  BigInteger p = 1, pPrev = 0;
+  BigInteger q = 0, qPrev = 1;
+  bool done = false;
+  while (!done) {
+    BigInteger a = low.numerator / low.denominator;
+    done = true;
+    if (!low.isInteger()) {
+      if (BigRational(a + 1) <= high) {
+        a += 1;
+      } else {
+        done = false;
+        BigRational nextLow = (high - BigRational(a)).reciprocal();
+        high = (low - BigRational(a)).reciprocal();
+        low = nextLow;
+      }
+    }
+    BigInteger pNext = a * p + pPrev;
+    BigInteger qNext = a * q + qPrev;
+    pPrev.swap(p);
+    p.swap(pNext);
+    qPrev.swap(q);
+    q.swap(qNext);
+  }
+  result.numerator.swap(p);
+  result.denominator.swap(q);
+  if (negative) result.numerator = -result.numerator;
+  return result;
+}
+
+
+BigRational BigRational::reciprocal() const
+{
+  BigRational result;
+  if (numerator.isZero() || isNan()) {
+    result.setNan();
+  } else {
+    result.numerator = denominator;
+    result.denominator = numerator;
+    if (numerator.isNegative()) {
+      result.numerator = -result.numerator;
+      result.denominator = -result.denominator;
+    }
+  }
+  return result;
+}
+
+
+/*  The numerator and denominator have no common factors, so neither do     *
+ *    their powers; no reduction is needed.                                  *
+ */
+BigRational BigRational::power(int exp) const
+{
+  BigRational base = (exp < 0) ? reciprocal() : *this;
+  unsigned magnitude = (exp < 0) ? 0U - (unsigned)exp : exp;
+  BigRational result;
+  if (base.isNan()) {
+    result.setNan();
+    return result;
+  }
+  result.numerator = base.numerator.power(magnitude);
+  result.denominator = base.denominator.power(magnitude);
+  return result;
+}
+
+
+/*  Determines the length, in characters, of the number.                     *
+ */
+unsigned BigRational::length() const
+{
+  if (isNan()) return 3;
+  if (isInteger()) return numerator.length();
+  return numerator.length() + 1 + denominator.length();
+}
+
+
+/*  Prints the number, accounting for nan and integers.                      *
+ */
+void BigRational::print(ostream &stream) const
+{
+  if (isNan()) {
+    stream << "nan";
+    return;
+  }
+  numerator.print(stream);
+  if (!isInteger()) {
+    stream << "/";
+    denominator.print(stream);
+  }
+}
+
+
+/*  Works as Fraction::printDecimal() does, with BigIntegers in place of     *
+ *    64-bit remainders.  Each digit costs one division by the denominator,  *
+ *    so the time is still proportional to the digits printed.  Numbers that *
+ *    fit in a Fraction are left to it.                                      *
+ */
+void BigRational::printDecimal(ostream &stream, unsigned digits) const
+{
+  Fraction small;
+  if (toSmall(&small)) {
+    small.printDecimal(stream, digits);
+    return;
+  }
+  if (numerator.isNegative()) stream << "-";
+  BigInteger whole, remainder;
+  BigInteger::divide(numerator.isNegative() ? -numerator : numerator,
+		     denominator, &whole, &remainder);
+  whole.print(stream);
+  if (remainder.isZero()) return;
+
+  BigInteger cycleFree = denominator;
+  unsigned twos = 0, fives = 0;
+  while ((cycleFree % 2).isZero()) {
+    cycleFree >>= 1;
+    twos++;
+  }
+  while ((cycleFree % 5).isZero()) {
+    cycleFree /= 5;
+    fives++;
+  }
+  unsigned cycleStart = (twos > fives) ? twos : fives;
+  bool repeats = (cycleFree != 1);
+
+  string expansion;
+  expansion.reserve(digits < 4096 ? digits : 4096);
+  BigInteger cycleRemainder, digit;
+  bool complete = false;
+  for (unsigned i = 0; i < digits && !remainder.isZero() && !complete; i++) {
+    if (i == cycleStart) cycleRemainder = remainder;
+    remainder *= 10;
+    BigInteger::divide(remainder, denominator, &digit, &remainder);
+    expansion += (char)('0' + digit.getSmall());
+    complete = (repeats && i >= cycleStart && remainder == cycleRemainder);
+  }
+  Fraction::printExpansion(stream, expansion, cycleStart, complete,
+			   remainder.isZero());
+}
+
+
+/*  Stores the number in the given Fraction, if it fits.  Returns whether    *
+ *    it did.                                                                *
+ */
+bool BigRational::toSmall(Fraction *value) const
+{
+  if (!fitsFraction()) return false;
+  if (isNan()) {
+    value->setNan();
+  } else {
+    value->setTerms(numerator.isNegative(), numerator.getSmall(),
+		    denominator.getSmall());
+  }
+  return true;
+}
+
+
+void BigRational::setSmall(const Fraction &value)
+{
+  if (value.isNan()) {
+    setNan();
+    return;
+  }
+  numerator = BigInteger(value.numerator, value.negative());
+  denominator = BigInteger(value.denominator(), false);
+}
+
+
+void BigRational::setNan()
+{
+  numerator = 1;
+  denominator = 0;
+}
@@ -0,0 +1,187 @@
+/*---------------------------------------------------------------------------*\
+ *                               bigRational.h                               *
+ *                    Interface for the BigRational class                    *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Represents a rational number exactly, however large its numerator and  *
+ *      denominator grow.                                                    *
+ *    Offers the same interface as the Fraction class, so that it can be     *
+ *      used wherever a Fraction is, and converts to and from one.           *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -The numerator and denominator are BigIntegers, which keep values that  *
+ *      fit in 64 bits inline.  While both fit, arithmetic is done by the    *
+ *      Fraction class itself; only a result that would overflow a Fraction  *
+ *      is redone with BigInteger arithmetic.  Small numbers thus cost about *
+ *      what a Fraction costs, and never allocate.                           *
+ *   -As with Fraction, results are always in lowest terms, and a failed     *
+ *      calculation (such as division by zero) is nan, signaled by a         *
+ *      denominator of 0.  Unlike Fraction, nothing ever overflows.          *
+\*---------------------------------------------------------------------------*/
+#ifndef BIGRATIONAL_CLASS_INCLUDED
+#define BIGRATIONAL_CLASS_INCLUDED
+#include<iostream>
+#include "fraction.h"
+#include "bigInteger.h"
+using namespace std;
+
+class BigRational
+{
+ public:
+  /*  Constructors                                                           *
+   *  Default constructor initializes the number to zero.                    *
+   *  Second constructor initializes to an integer.                          *
+   *  Third constructor initializes based on a numerator and denominator.    *
+   *  Fourth constructor converts a Fraction, exactly.                       *
+   *  Fifth constructor initializes to an arbitrarily large integer.         *
+   *  Sixth constructor initializes based on an arbitrarily large numerator  *
+   *    and denominator.                                                     *
+   */
+  BigRational();
+  BigRational(long long number);
+  BigRational(long long numerator, long long denominator);
+  BigRational(Fraction value);
+  BigRational(const BigInteger &number);
+  BigRational(const BigInteger &numerator, const BigInteger &denominator);
+
+  /*  Return the numerator, denominator, and sign, respectively.  The        *
+   *    numerator carries the sign; the denominator is never negative.       *
+   */
+  const BigInteger &getNumerator() const;
+  const BigInteger &getDenominator() const;
+  bool isNegative() const;
+
+  /*  Returns whether the number is nan, or is an integer, respectively.     *
+   */
+  bool isNan() const;
+  bool isInteger() const;
+
+  /*  Conversions.  toFraction() is nan if the number is too large to be a   *
+   *    Fraction; toDouble() rounds.                                         *
+   */
+  bool fitsFraction() const;
+  Fraction toFraction() const;
+  double toDouble() const;
+
+  /*  Assignment and arithmetic operators work as with Fraction, with        *
+   *    either other BigRationals or integers.                               *
+   *  Non-assigning arithmetic operators are defined below the class.        *
+   */
+  BigRational &operator=(long long rhs);
+  BigRational operator-() const;
+  BigRational &operator*=(const BigRational &rhs);
+  BigRational &operator/=(const BigRational &rhs);
+  BigRational &operator+=(const BigRational &rhs);
+  BigRational &operator-=(const BigRational &rhs);
+
+  /*  Comparison operators.                                                  *
+   *  Other comparison operators are defined below the class.                *
+   *  As with Fraction, nan is unordered:  two nans are equal under ==, and  *
+   *    unequal to anything else, but <, >, <= and >= are all false for it.  *
+   */
+  bool operator==(const BigRational &rhs) const;
+  bool operator<(const BigRational &rhs) const;
+
+  /*  Returns the square root of the number.  As with Fraction, the root is  *
+   *    exact whenever one exists, and is otherwise the simplest number      *
+   *    found within 1/precision of the true root.  If called on a negative  *
+   *    number, returns nan.                                                 *
+   */
+  BigRational sqroot() const;
+  BigRational sqroot(const BigInteger &precision) const;
+
+  /*  Rational approximation, to keep terms small.                           *
+   *  limitDenominator returns the number closest to this one whose          *
+   *    denominator is at most the given limit, as Fraction's does.          *
+   *  simplest returns the simplest number (that with the smallest           *
+   *    denominator, then the smallest numerator) within the given           *
+   *    tolerance of this one, inclusive.                                    *
+   *  A limit that is not positive, or a negative tolerance, gives nan.      *
+   */
+  BigRational limitDenominator(const BigInteger &limit) const;
+  BigRational simplest(const BigRational &tolerance) const;
+
+  /*  Returns the reciprocal of the number.                                  *
+   */
+  BigRational reciprocal() const;
+
+  /*  Returns the number raised to the given power; negative exponents give  *
+   *    powers of the reciprocal.                                            *
+   */
+  BigRational power(int exp) const;
+
+  /*  Returns the number of characters that the number will take up when    *
+   *    printed.  Useful for alignment purposes.                             *
+   */
+  unsigned length() const;
+
+  /*  Prints the number to the given ostream in the form [-]###/###          *
+   */
+  void print(ostream &stream) const;
+
+  /*  Prints the number's exact decimal expansion, to at most the given      *
+   *    number of digits after the decimal point, in the same form as        *
+   *    Fraction::printDecimal().                                            *
+   */
+  void printDecimal(ostream &stream, unsigned digits) const;
+
+ private:
+  BigInteger numerator;
+  BigInteger denominator;
+
+  bool toSmall(Fraction *value) const;
+  void setSmall(const Fraction &value);
+  void setNan();
+};
+
+
+/*  The following define further arithmetic and comparison operators in      *
+ *    terms of the ones already declared within the class.  Integers convert *
+ *    to BigRationals implicitly, so these work between the two in any       *
+ *    order.                                                                 *
+ */
+inline BigRational operator*(BigRational lhs, const BigRational &rhs)
+{
+  lhs *= rhs;
+  return lhs;
+}
+
+inline BigRational operator/(BigRational lhs, const BigRational &rhs)
+{
+  lhs /= rhs;
+  return lhs;
+}
+
+inline BigRational operator+(BigRational lhs, const BigRational &rhs)
+{
+  lhs += rhs;
+  return lhs;
+}
+
+inline BigRational operator-(BigRational lhs, const BigRational &rhs)
+{
+  lhs -= rhs;
+  return lhs;
+}
+
+inline bool operator!=(const BigRational &lhs, const BigRational &rhs)
+{
+  return !(lhs == rhs);
+}
+
+inline bool operator>(const BigRational &lhs, const BigRational &rhs)
+{
+  return rhs < lhs;
+}
+
+inline bool operator<=(const BigRational &lhs, const BigRational &rhs)
+{
+  return !lhs.isNan() && !rhs.isNan() && !(rhs < lhs);
+}
+
+inline bool operator>=(const BigRational &lhs, const BigRational &rhs)
+{
+  return !lhs.isNan() && !rhs.isNan() && !(lhs < rhs);
+}
+
+#endif
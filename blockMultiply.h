@@ -0,0 +1,114 @@
+/*---------------------------------------------------------------------------*\
+ *                              blockMultiply.h                              *
+ *                  A cache-blocked matrix multiplication kernel             *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Multiplies two matrices of any scalar type held as plain row-major     *
+ *      arrays, such as the entries of a Matrix, or an array of doubles.     *
+ *    The work is split into tiles small enough to stay in cache while they  *
+ *      are used.  For built-in types such as double, each pass over the     *
+ *      shared dimension within a tile computes a 2x2 block of the result,   *
+ *      so every entry loaded is used twice and four sums proceed at once.   *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -The right matrix is passed transposed, so that its columns, like the   *
+ *      rows on the left, are contiguous.                                    *
+ *   -The result must start out as zero.  Each entry has its products added  *
+ *      to it one at a time, in order along the shared dimension, exactly as *
+ *      the textbook triple loop adds them; blocking only changes when, not  *
+ *      in what order.  So for Fraction, where a sum that overflows is nan,  *
+ *      the results are identical to the unblocked loop's.                   *
+\*---------------------------------------------------------------------------*/
+#ifndef BLOCKMULTIPLY_INCLUDED
+#define BLOCKMULTIPLY_INCLUDED
+#include<algorithm>
+#include<type_traits>
+
+/*  Tiles cover this many rows of the result by as many columns, and as many *
+ *    entries of the shared dimension as fit in BLOCK_BYTES.                 *
+ */
+static const int BLOCK_ENTRIES = 32;
+static const int BLOCK_BYTES = 4096;
+
+
+/*  Adds to result[i][j], for each i and j given, the products of left[i][k] *
+ *    and rightT[j][k] for k in [kBegin, kEnd).                              *
+ *  For built-in types, rows and columns are taken in pairs where they can   *
+ *    be, with any odd one left over done alone.  Other types, like          *
+ *    Fraction, take them one at a time: their arithmetic is far too large   *
+ *    to keep four sums in registers, and pairing them was measured to be    *
+ *    slower.                                                                *
+ */
+template<class T>
+void multiplyTile(const T *left, const T *rightT, T *result, int inner,
+                  int cols, int iBegin, int iEnd, int jBegin, int jEnd,
+                  int kBegin, int kEnd)
+{
+  const bool paired = std::is_arithmetic<T>::value;
+  int i = iBegin;
+  for (; paired && i + 1 < iEnd; i += 2) {
+    const T *left0 = left + i * inner, *left1 = left0 + inner;
+    T *result0 = result + i * cols, *result1 = result0 + cols;
+    int j = jBegin;
+    for (; j + 1 < jEnd; j += 2) {
+      const T *right0 = rightT + j * inner, *right1 = right0 + inner;
+      T sum00 = result0[j], sum01 = result0[j + 1];
+      T sum10 = result1[j], sum11 = result1[j + 1];
+      for (int k = kBegin; k < kEnd; k++) {
+        sum00 += left0[k] * right0[k];
+        sum01 += left0[k] * right1[k];
+        sum10 += left1[k] * right0[k];
+        sum11 += left1[k] * right1[k];
+      }
+      result0[j] = sum00;
+      result0[j + 1] = sum01;
+      result1[j] = sum10;
+      result1[j + 1] = sum11;
+    }
+    for (; j < jEnd; j++) {
+      const T *right0 = rightT + j * inner;
+      T sum0 = result0[j], sum1 = result1[j];
+      for (int k = kBegin; k < kEnd; k++) {
+        sum0 += left0[k] * right0[k];
+        sum1 += left1[k] * right0[k];
+      }
+      result0[j] = sum0;
+      result1[j] = sum1;
+    }
+  }
+  for (; i < iEnd; i++) {
+    const T *left0 = left + i * inner;
+    for (int j = jBegin; j < jEnd; j++) {
+      const T *right0 = rightT + j * inner;
+      T sum = result[i * cols + j];
+      for (int k = kBegin; k < kEnd; k++) {
+        sum += left0[k] * right0[k];
+      }
+      result[i * cols + j] = sum;
+    }
+  }
+}
+
+
+/*  Sets result (rows x cols, all zero beforehand) to left (rows x inner)    *
+ *    times right, given as rightT, its transpose (cols x inner).            *
+ */
+template<class T>
+void blockMultiply(const T *left, const T *rightT, T *result, int rows,
+                   int inner, int cols)
+{
+  int kBlock = std::max(BLOCK_BYTES / (int)sizeof(T), 2 * BLOCK_ENTRIES);
+  for (int k = 0; k < inner; k += kBlock) {
+    int kEnd = std::min(inner, k + kBlock);
+    for (int i = 0; i < rows; i += BLOCK_ENTRIES) {
+      int iEnd = std::min(rows, i + BLOCK_ENTRIES);
+      for (int j = 0; j < cols; j += BLOCK_ENTRIES) {
+        int jEnd = std::min(cols, j + BLOCK_ENTRIES);
+        multiplyTile(left, rightT, result, inner, cols, i, iEnd, j, jEnd,
+                     k, kEnd);
+      }
+    }
+  }
+}
+
+#endif
@@ -6,357 +6,237 @@
  *  Last Modified: May 8, 2014                                               *
 \*---------------------------------------------------------------------------*/
 #include<iostream>
+#include<charconv>
+#include<climits>
+#include<cstring>
+#include<string>
 #include<math.h>
 #include "fraction.h"
 using namespace std;
 
-/* Default constructor sets fraction to zero.                                *
+/*  Square roots are found at twice the width of a term, as with the rest    *
+ *    of the arithmetic (see fraction.h).                                    *
  */
-Fraction::Fraction()
-{
-  negative = false;
-  numerator = 0;
-  denominator = 1;
-}
-
-
-/*  Sets the fraction to be the given number.                                *
- */
-Fraction::Fraction(long long number)
-{
-  negative = (number < 0);
-  numerator = negative ? (-number) : number;
-  denominator = 1;
-}
+typedef unsigned __int128 uint128;
 
 
-/*  Sets the fraction to be (numerator/denominator), properly reduced        * 
+/*  Returns the floor of the square root of a 128-bit number.  The floating- *
+ *    point root is only an estimate, so one step of Newton's method and a   *
+ *    final adjustment make it exact.  The root always fits in 64 bits.      *
  */
-Fraction::Fraction(long long numerator, long long denominator)
-{
-  /* Equivalent to logical XOR; negative iff exactly one is negative  */
-  negative = ((numerator < 0) != (denominator < 0));
-  this->numerator = (numerator < 0) ? (-numerator) : numerator;
-  this->denominator = (denominator < 0) ? (-denominator) : denominator;
-  reduce(&(this->numerator), &(this->denominator));
-}
-
-
-/*-------------NEEDS TESTING----------------*/
-/*  Sets the fraction based on the given mixed number.                       *
- *  If the whole number is negative, it signifies that the entire fraction is*
- *    negative.  If this is not the desired behavior, make use of arithmetic *
- *    instead.                                                               *
- */
-Fraction::Fraction(long long number, unsigned long long numerator,
-		   unsigned long long denominator)
-{
-  reduce(&numerator, &denominator);
-  negative = (number < 0);
-  if (negative) number = -number;
-  long long total_numerator = (number * denominator) + numerator;
-  this->numerator = total_numerator;
-  this->denominator = denominator;
-}
-
-
-unsigned long long Fraction::getNumerator()
-{
-  return numerator;
-}
-
-
-unsigned long long Fraction::getDenominator()
-{
-  return denominator;
-}
-
-
-bool Fraction::isNegative()
-{
-  /* Accounts for nan; nan is not negative. */
-  return (negative && numerator != 0);
-}
-
-
-Fraction Fraction::operator=(long long rhs)
-{
-  if (rhs < 0) {
-    negative = true;
-    rhs = -rhs;
-  }
-  numerator = rhs;
-  denominator = 1;
-  return *this;
-}
-
-
-Fraction Fraction::operator-()
+static uint128 squareRoot(uint128 n)
 {
-  negative = !negative;
-  return *this;
+  if (n == 0) return 0;
+  uint128 root = (uint128)sqrtl((long double)n);
+  if (root > ULLONG_MAX) root = ULLONG_MAX;
+  if (root == 0) root = 1;
+  root = (root + n / root) / 2;
+  if (root > ULLONG_MAX) root = ULLONG_MAX;
+  while (root * root > n) root--;
+  while (root < ULLONG_MAX && (root + 1) * (root + 1) <= n) root++;
+  return root;
 }
 
 
-/*  All arithmetic operations reduce the given numbers as quickly as possible,*
- *    to avoid overflow where possible.                                       *
+/*  Returns the sqare root (or nan) without modifying the existing fraction, *
+ *    to within the default precision.                                       *
  */
-Fraction Fraction::operator*=(long long rhs)
-{
-  if (rhs < 0) {
-    negative = !negative;
-    rhs = -rhs;
-  }
-  reduce(&(this->denominator), (long long unsigned *) &rhs);
-  numerator *= rhs;
-  return *this;
-}
-
-
-Fraction Fraction::operator*=(Fraction rhs)
-{
-  unsigned long long num = rhs.getNumerator();
-  unsigned long long den = rhs.getDenominator();
-  reduce(&numerator, &den);
-  reduce(&num, &denominator);
-  numerator *= num;
-  denominator *= den;
-  if (rhs.negative) negative = !negative;
-  return *this;
-}
-
-
-Fraction Fraction::operator/=(long long rhs)
+Fraction Fraction::sqroot() const
 {
-  if (rhs < 0) {
-    negative = !negative;
-    rhs = -rhs;
-  }
-  reduce(&(this->numerator), (long long unsigned *) &rhs);
-  denominator *= rhs;
-  return *this;
+  return sqroot(DEFAULT_ROOT_PRECISION);
 }
 
 
-Fraction Fraction::operator/=(Fraction rhs)
-{
-  unsigned long long num = rhs.getNumerator();
-  unsigned long long den = rhs.getDenominator();
-  reduce(&numerator, &num);
-  reduce(&den, &denominator);
-  numerator *= den;
-  denominator *= num;
-  if (rhs.isNegative()) negative = !negative;
-  return *this;
-}
-
-
-/*  Must account for three cases:                                            *
- *  -A positive fraction becoming negative, by adding a negative number of   *
- *     greater magnitude                                                     *
- *  -A negative fraction becoming positive, by adding a positive number of   *
- *     greater magnitude                                                     *
- *  -A fraction maintaining its sign                                         *
+/*  If both terms are perfect squares, the root is exact:  their roots have  *
+ *    no common factors either, so the result is already in lowest terms.    *
+ *  Otherwise, the root is approximated by the convergents of its continued  *
+ *    fraction, which are the best approximations for their size.  Writing   *
+ *    sqrt(n/d) as sqrt(N)/d with N = n*d, the partial quotients come from   *
+ *    the classic recurrence for quadratic irrationals (P + sqrt(N)) / Q:    *
+ *      a = floor((P + sqrt(N)) / Q),  P' = a*Q - P,  Q' = (N - P'^2) / Q    *
+ *    in which every division is exact.  The error of a convergent h/k is    *
+ *    less than 1/(k * k'), where k' is the next convergent's denominator,   *
+ *    so iteration stops once k * k' reaches the requested precision.        *
+ *  All of this fits in 128 bits.  If a convergent would no longer fit in a  *
+ *    Fraction before the precision is reached, the last one that did is     *
+ *    returned.                                                              *
  */
-Fraction Fraction::operator+=(long long rhs)
+Fraction Fraction::sqroot(unsigned long long precision) const
 {
-  if ((!negative && rhs < 0) &&
-      ((unsigned long long)(-rhs * denominator) > numerator)) {
-    negative = true;
-    numerator = (-rhs * denominator) - numerator;
-  } else if ((negative && rhs > 0) &&
-	     ((unsigned long long)(rhs * denominator) > numerator)) {
-    negative = false;
-    numerator = (rhs * denominator) - numerator;
-  } else {
-    numerator += (rhs * denominator);
+  Fraction result;
+  if (isNegative() || isNan()) {
+    result.setNan();
+    return result;
   }
-  reduce(&numerator, &denominator);
-  return *this;
-}
-
-/*  Must account for three cases:                                            *
- *  -Adding a fraction of the same sign                                      *
- *  -Adding a fraction of a different sign, greater magnitude                *
- *  -Adding a fraction of a different sign, lesser magnitude                 *
- */
-Fraction Fraction::operator+=(Fraction rhs)
-{
-  unsigned long long lcm = LCM(denominator, rhs.denominator);
-  numerator *= (lcm / denominator);
-  rhs.numerator *= (lcm / rhs.denominator);
-  if (rhs.negative == negative) {
-    numerator += rhs.numerator;
-  } else if (rhs.numerator > numerator) {
-    numerator = rhs.numerator - numerator;
-    negative = !negative;
-  } else {
-    numerator -= rhs.numerator;
+  unsigned long long den = denominator();
+  uint128 numRoot = squareRoot(numerator);
+  uint128 denRoot = squareRoot(den);
+  if (numRoot * numRoot == numerator && denRoot * denRoot == den) {
+    result.setTerms(false, numRoot, denRoot);
+    return result;
   }
-  denominator = lcm;
-  reduce(&numerator, &denominator);
-  return *this;
-}
-
-Fraction Fraction::operator-=(long long rhs)
-{
-  return operator+=(-rhs);
-}
-
-Fraction Fraction::operator-=(Fraction rhs)
-{
-  return operator+=(-rhs);
-}
-
-bool Fraction::operator==(Fraction rhs)
-{
-  return ((negative == rhs.negative) &&
-	  (denominator == rhs.denominator) &&
-	  (numerator == rhs.numerator));
-}
-
-/* Must account for four cases:                                              *
- * -Zero (denominator may be anything but zero, which signals nan)           *
- * -Non-integer (cannot equal an integer)                                    *
- * -Positive and negative numbers                                            *
- */
-bool Fraction::operator==(long long rhs)
-{
-  if (rhs == 0) return numerator == 0 && denominator != 0;
-  if (denominator > 1) return false;
-  if (rhs < 0) return negative && numerator == (unsigned long long)-rhs;
-  return numerator == (unsigned long long)rhs;
-}
-
-
-bool Fraction::operator<(long long rhs)
-{
-  return (*this - rhs).isNegative();
-}
-
 
-bool Fraction::operator<(Fraction rhs)
-{
-  return (*this - rhs).isNegative();
-}
-
-
-/*  Returns the result of raising the current fraction to the given integer  *
- *    exponent.                                                              *
- *  Does not modify the existing fraction.                                   *
- */
-Fraction Fraction::power(int exp)
-{
-  Fraction result(1);
-  Fraction base = *this;
-  for (int i = 0; i < exp; i++) {
-    result *= base;
+  uint128 n = (uint128)numerator * den;
+  uint128 root = squareRoot(n);
+  uint128 p = 0;
+  uint128 q = den;
+  uint128 a = root / q;
+  uint128 h = a, hPrev = 1;           /* Convergent numerators   */
+  uint128 k = 1, kPrev = 0;           /* Convergent denominators */
+  while (true) {
+    result.setTerms(false, h, k);
+    p = a * q - p;
+    q = (n - p * p) / q;
+    a = (root + p) / q;
+    uint128 hNext = a * h + hPrev;
+    uint128 kNext = a * k + kPrev;
+    if (kNext > MAX_DENOMINATOR || k * kNext >= precision) break;
+    if (hNext > ULLONG_MAX) break;
+    hPrev = h;
+    h = hNext;
+    kPrev = k;
+    k = kNext;
   }
   return result;
 }
 
-
-/*  Returns the reciprocal without modifying the existing fraction.          *
- */
-Fraction Fraction::reciprocal()
-{
-  return Fraction((negative ? -denominator : denominator), numerator);
-}
-
-
-/*  Returns the sqare root (or nan) without modifying the existing fraction. *
- */
-Fraction Fraction::sqroot()
-{
-  if(!negative)
-    return Fraction(sqrt((double)numerator), sqrt((double)denominator));
-  return Fraction(1, 0);
-}
-
 /*  Determines the length, in characters, of the existing fraction.          *
  */
-unsigned Fraction::length()
+unsigned Fraction::length() const
 {
   if (numerator == 0) return 1;         /* Fraction is 0 */
-  if (denominator == 0) return 3;       /* Fraction is nan */
+  if (isNan()) return 3;                /* Fraction is nan */
   unsigned len = 0;
-  if (negative) len++;                  /* Account for the '-' */
+  if (negative()) len++;                /* Account for the '-' */
   len += length(numerator);
-  if (denominator == 1) return len;     /* Fraction is an integer */
-  return len + 1 + length(denominator); /* Account for the '/' */
+  unsigned long long den = denominator();
+  if (den == 1) return len;             /* Fraction is an integer */
+  return len + 1 + length(den);         /* Account for the '/' */
 }
 
-/*  Returns the length of an integer.                                        *
+
+static const unsigned long long POWERS_OF_TEN[20] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+  100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/*  Returns the length of an integer, without a loop:  a number of b bits    *
+ *    has either floor(b * log10(2)) or one more digits, and a single        *
+ *    comparison with a power of ten decides which.  1233/4096 is just under *
+ *    log10(2), and is exact enough for all b <= 64.                         *
  */
 unsigned Fraction::length(unsigned long long x)
 {
-  if (x == 0) return 1;
-  unsigned len = 0;
-  while (x > 0) {
-    len++;
-    x /= 10;
-  }
-  return len;
+  x |= 1;                               /* 0 has one digit, as 1 does */
+  unsigned digits = ((64 - __builtin_clzll(x)) * 1233) >> 12;
+  return digits + (x >= POWERS_OF_TEN[digits]);
 }
 
 
 /*  Prints the fraction, accounting for nan, negative numbers, and integers.*
  */
-void Fraction::print(ostream &stream)
+void Fraction::print(ostream &stream) const
 {
-  if (numerator == 0) {
-    stream << 0;
-  } else if (denominator == 1) {
-    stream << (negative? "-" : "") << numerator;
-  } else if (denominator == 0) {
-    stream << "nan";
-  } else {
-    stream << (negative ? "-" : "")  << numerator << "/" << denominator;
-  }
+  char buffer[MAX_LENGTH];
+  stream.write(buffer, format(buffer));
 }
 
 
-/*  Reduces the given numbers by dividing out all multiples.                 *
- *  Takes the numbers by reference, modifying both (if necessary).           *
+/*  Converts the terms with to_chars, which neither allocates nor consults   *
+ *    the locale, as stream output does.                                     *
  */
-void Fraction::reduce(unsigned long long *num1, unsigned long long *num2)
+unsigned Fraction::format(char *buffer) const
 {
-  int n1 = *num1;    /* Use local variables to avoid frequent dereferencing */
-  int n2 = *num2;
-  for (int i = 2; i <= n1 && i <= n2; i++) {
-    if (n1 % i == 0 && n2 % i == 0) {
-      n1 /= i;
-      n2 /= i;
-    }
+  if (isNan()) {
+    memcpy(buffer, "nan", 3);
+    return 3;
   }
-  *num1 = n1;
-  *num2 = n2;
+  char *end = buffer;
+  if (negative()) *end++ = '-';
+  end = to_chars(end, buffer + MAX_LENGTH, numerator).ptr;
+  if (denominator() != 1) {
+    *end++ = '/';
+    end = to_chars(end, buffer + MAX_LENGTH, denominator()).ptr;
+  }
+  return end - buffer;
 }
 
 
-/*  Returns the Least Common Multiple of the given two numbers.              *
- *  Takes advantage of the fact LCM(a,b) == |a*b|/GCD(a,b)                   *
- *  Takes unsigned numbers, so no need to worry about absolute value.        *
- *  Order of caluclations is to make overflow less likely.                   *
+/*  Uses long division, one digit per step, so the time taken is            *
+ *    proportional to the digits printed.  No floating point is involved.    *
+ *  With the denominator written as 2^a * 5^b * d, where d has no factors of *
+ *    2 or 5, the expansion terminates if d is 1.  Otherwise the first       *
+ *    max(a, b) digits do not repeat, and every digit after them is part of  *
+ *    the cycle.  The cycle is complete once the remainder returns to what   *
+ *    it was where the cycle began, so finding it takes no extra storage.    *
  */
-unsigned long long Fraction::LCM(unsigned long long num1,
-				 unsigned long long num2)
+void Fraction::printDecimal(ostream &stream, unsigned digits) const
 {
-  return (num1 / GCD(num1, num2)) * num2;
+  if (isNan()) {
+    stream << "nan";
+    return;
+  }
+  unsigned long long den = denominator();
+  if (negative()) stream << "-";
+  stream << numerator / den;
+  unsigned long long remainder = numerator % den;
+  if (remainder == 0) return;
+
+  unsigned long long cycleFree = den >> __builtin_ctzll(den);
+  unsigned fives = 0;
+  while (cycleFree % 5 == 0) {
+    cycleFree /= 5;
+    fives++;
+  }
+  unsigned cycleStart = __builtin_ctzll(den);
+  if (fives > cycleStart) cycleStart = fives;
+
+  string expansion;
+  expansion.reserve(digits < 4096 ? digits : 4096);
+  unsigned long long cycleRemainder = 0;
+  bool complete = false;
+  for (unsigned i = 0; i < digits && remainder != 0 && !complete; i++) {
+    if (i == cycleStart) cycleRemainder = remainder;
+    uint128 scaled = (uint128)remainder * 10;
+    expansion += (char)('0' + (unsigned)(scaled / den));
+    remainder = (unsigned long long)(scaled % den);
+    complete = (cycleFree != 1 && i >= cycleStart &&
+		remainder == cycleRemainder);
+  }
+  printExpansion(stream, expansion, cycleStart, complete, remainder == 0);
 }
 
 
-/*  Returns the Greatest Common Divisor of the given two numbers.            *
- *  Utilizes the Euclidean algorithm.                                        *
- *  The first base case is merely for speed considerations, and to avoid     *
- *    stack overflow when one of the numbers has become very small.          *
- *  NOTE:  Change to loop.
+/*  Prints the digits after the decimal point, as found by printDecimal().  *
+ *  If a whole cycle was found, the digits from cycleStart on are that cycle.*
+ *  Otherwise, the digits are all there are if the expansion was exact, and  *
+ *    are followed by "..." if not.                                          *
  */
-unsigned long long Fraction::GCD(unsigned long long num1,
-				 unsigned long long num2)
+void Fraction::printExpansion(ostream &stream, const string &expansion,
+			      unsigned cycleStart, bool repeats, bool exact)
 {
-  if (num1 == num2) return num1;
-  if (num1 > num2) return GCD(num2, num1 - num2);
-  return GCD(num1, num2 - num1);
+  if (!expansion.empty()) stream << ".";
+  if (repeats) {
+    stream.write(expansion.data(), cycleStart);
+    stream << "(";
+    stream.write(expansion.data() + cycleStart, expansion.size() - cycleStart);
+    stream << ")";
+  } else {
+    stream << expansion;
+    if (!exact) stream << "...";
+  }
 }
 
+
+/*  The arithmetic in fraction.h is meant to be usable at compile time;      *
+ *  these make sure it stays that way.                                       *
+ */
+static_assert(Fraction(6, -4) + Fraction(1, 3) == Fraction(-7, 6),
+	      "Fraction arithmetic must be constexpr");
+static_assert(Fraction(2, 3).power(-3) == Fraction(27, 8),
+	      "Fraction arithmetic must be constexpr");
+static_assert((Fraction(1, 0) * 0).isNan(),
+	      "Fraction arithmetic must be constexpr");
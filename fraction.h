@@ -14,18 +14,27 @@
  *      such in this class, instead of being rounded, as in a double.        *
  *                                                                           *
  *  Notes:                                                                   *
- *   -Overflow is possible on a fraction.  The maximumum value for a         *
- *      numerator or denominator is ULLONG_MAX.                              *
+ *   -The maximumum value for a numerator is ULLONG_MAX, and for a           *
+ *      denominator, LLONG_MAX (see MAX_DENOMINATOR below).                  *
+ *      Intermediate results are computed at 128 bits and reduced before     *
+ *      being narrowed, so arithmetic never silently wraps around; a result  *
+ *      that still does not fit in lowest terms is nan (see below).          *
  *   -The result of a successful computation is guaranteed to be in lowest   *
  *      terms.                                                               *
- *   -When calculations fail, the resulting Fraction is represented as       *
- *      "Not-A-Number", signaled by the value of the denominator being 0.    *
- *      Such a value is printed as "nan".                                    *
+ *   -When calculations fail or overflow, the resulting Fraction is          *
+ *      represented as "Not-A-Number", signaled by the value of the          *
+ *      denominator being 0.  Such a value is printed as "nan", and any      *
+ *      arithmetic involving it is nan as well.                              *
+ *   -A Fraction takes 16 bytes: the sign is kept in the top bit of the      *
+ *      denominator's word, rather than in a separate bool that padding      *
+ *      would round up to 8 bytes more.  Zero is never negative, and nan is  *
+ *      always 1/0, so equal fractions are stored identically.               *
 \*-------------------------------------------------------------------------- */
 
 #ifndef FRACTION_CLASS_INCLUDED
 #define FRACTION_CLASS_INCLUDED
 #include<iostream>
+#include<string>
 using namespace std;
 
 class Fraction
@@ -37,17 +46,27 @@ class Fraction
    *  Third constructor initializes based on a numerator and denominator.    *
    *  Fourth constructor initializes based on a mixed number.                *
    */
-  Fraction();
-  Fraction(long long number);
-  Fraction(long long numerator, long long denominator);
-  Fraction(long long number, unsigned long long numerator,
-           unsigned long long denominator);
+  constexpr Fraction();
+  constexpr Fraction(long long number);
+  constexpr Fraction(long long numerator, long long denominator);
+  constexpr Fraction(long long number, unsigned long long numerator,
+                     unsigned long long denominator);
 
   /*  Return the numerator, denominator, and sign, respectively.             *
    */
-  unsigned long long getNumerator();
-  unsigned long long getDenominator();
-  bool isNegative();
+  constexpr unsigned long long getNumerator() const;
+  constexpr unsigned long long getDenominator() const;
+  constexpr bool isNegative() const;
+
+  /*  The largest denominator a fraction can have.  Results whose reduced    *
+   *    denominators are any larger are nan.                                 *
+   */
+  static const unsigned long long MAX_DENOMINATOR = 0x7fffffffffffffffULL;
+
+  /*  Returns whether the fraction is nan, the result of a failed or         *
+   *    overflowing calculation.                                             *
+   */
+  constexpr bool isNan() const;
 
   /*  Assignment operators do assignment as expected.  Arithmetic is based   *
    *    on rules for fraction arithmetic, as one would expect.               *
@@ -55,137 +74,713 @@ class Fraction
    *  Non-assigning arithmetic operators are defined below the class.        *
    *  Modulus is not defined for fractions.                                  *
    */
-  Fraction operator=(long long rhs);
-  Fraction operator-();
-  Fraction operator*=(long long rhs);
-  Fraction operator*=(Fraction rhs);
-  Fraction operator/=(long long rhs);
-  Fraction operator/=(Fraction rhs);
-  Fraction operator+=(long long rhs);
-  Fraction operator+=(Fraction rhs);
-  Fraction operator-=(long long rhs);
-  Fraction operator-=(Fraction rhs);
+  constexpr Fraction operator=(long long rhs);
+  constexpr Fraction operator-() const;
+  constexpr Fraction operator*=(long long rhs);
+  constexpr Fraction operator*=(const Fraction &rhs);
+  constexpr Fraction operator/=(long long rhs);
+  constexpr Fraction operator/=(const Fraction &rhs);
+  constexpr Fraction operator+=(long long rhs);
+  constexpr Fraction operator+=(const Fraction &rhs);
+  constexpr Fraction operator-=(long long rhs);
+  constexpr Fraction operator-=(const Fraction &rhs);
 
   /*  Comparison operators can compare with either another fraction or with  *
    *    an integer.                                                          *
    *  Other comparison operators are defined below the class.                *
+   *  Comparisons never compute a difference, and so never reduce or         *
+   *    overflow.  Nan has one stored form, so two nans are equal under ==,  *
+   *    and nan is unequal to everything else; but it is unordered, so <,    *
+   *    >, <= and >= are all false for it.  Pivot searches (see largerPivot  *
+   *    in matrix.cpp) use only <, so a nan entry is never chosen over       *
+   *    another.                                                             *
    */
-  bool operator==(long long rhs);
-  bool operator==(Fraction rhs);
-  bool operator<(long long rhs);
-  bool operator<(Fraction rhs);
+  constexpr bool operator==(long long rhs) const;
+  constexpr bool operator==(const Fraction &rhs) const;
+  constexpr bool operator<(long long rhs) const;
+  constexpr bool operator<(const Fraction &rhs) const;
 
   /*  Returns the square root of the fraction.                               *
-   *  Note that the numerator and denominator may be rounded, so this        *
-   *    calculation may not be exact.                                        *
+   *  The root is exact whenever the numerator and denominator are both      *
+   *    perfect squares.  Otherwise it is the simplest fraction found within *
+   *    1/precision of the true root (or the closest that fits, if no        *
+   *    fraction that close does), DEFAULT_ROOT_PRECISION by default.        *
    *  If called on a negative fraction, returns nan.                         *
    */
-  Fraction sqroot();
+  Fraction sqroot() const;
+  Fraction sqroot(unsigned long long precision) const;
+  static const unsigned long long DEFAULT_ROOT_PRECISION =
+    1000000000000000000ULL;
 
   /*  Returns the reciprocal of the fraction.                                *
    */
-  Fraction reciprocal();
+  constexpr Fraction reciprocal() const;
+
+  /*  Returns the fraction raised to the given power; negative exponents     *
+   *    give powers of the reciprocal.  A result too large to represent is   *
+   *    nan.                                                                 *
+   */
+  constexpr Fraction power(int exp) const;
 
-  /*  Returns the fraction raised to the given power.  Beware overflow.      *
+  /*  Returns the fraction closest to this one whose denominator is at most  *
+   *    the given limit; of two equally close, the one with the smaller     *
+   *    denominator.  Useful for keeping decimal data, such as 0.333333333,  *
+   *    in small terms (1/3).  A limit of zero gives nan.                    *
    */
-  Fraction power(int exp);
+  constexpr Fraction limitDenominator(unsigned long long limit) const;
 
   /*  Returns the number of characters that the fraction will take up when   *
    *    printed.  Useful for alignment purposes.                             *
    */
-  unsigned length();
+  unsigned length() const;
 
   /*  Prints the fraction to the given ostream in the form [-]###/###        *
    */
-  void print(ostream &stream);
+  void print(ostream &stream) const;
+
+  /*  Writes the fraction, exactly as print() would, into the given buffer,  *
+   *    which must hold at least MAX_LENGTH characters.  Returns the number  *
+   *    of characters written; no terminating null is added.                 *
+   *  Useful for formatting many fractions without going through a stream.   *
+   */
+  unsigned format(char *buffer) const;
+  static const unsigned MAX_LENGTH = 41;
+
+  /*  Prints the fraction's exact decimal expansion, to at most the given    *
+   *    number of digits after the decimal point.  Digits that repeat        *
+   *    forever are put in parentheses, as in 0.1(6) for 1/6, if a whole     *
+   *    cycle of them fits; an expansion cut short ends in "...".            *
+   */
+  void printDecimal(ostream &stream, unsigned digits) const;
 
  private:
-  bool negative;
-  unsigned long long numerator;
-  unsigned long long denominator;
+  /*  BigRational and FractionVector work directly on the terms of the     *
+   *    Fractions that they hold.                                          */
+  friend class BigRational;
+  friend class FractionVector;
+
+  /*  Intermediate results are computed at twice the width of a term, so   *
+   *    that products of two terms can never wrap around.  Results are       *
+   *    narrowed back to 64 bits only after they have been reduced.          *
+   */
+  typedef unsigned __int128 uint128;
 
-  void reduce(unsigned long long *num1, unsigned long long *num2);
-  unsigned long long GCD(unsigned long long num1, unsigned long long num2);
-  unsigned long long LCM(unsigned long long num1, unsigned long long num2);
-  unsigned length(unsigned long long x);
+  unsigned long long numerator;
+  unsigned long long signAndDenominator;  /* Sign bit, then the denominator */
+
+  static const unsigned long long SIGN_BIT = 1ULL << 63;
+  constexpr bool negative() const;
+  constexpr unsigned long long denominator() const;
+  constexpr void setTerms(bool negative, unsigned long long numerator,
+                          unsigned long long denominator);
+  constexpr void multiply(bool negative, unsigned long long num,
+                          unsigned long long den);
+
+  constexpr void setNan();
+  static void printExpansion(ostream &stream, const string &expansion,
+                             unsigned cycleStart, bool repeats, bool exact);
+  constexpr void reduce(unsigned long long *num1, unsigned long long *num2);
+  static constexpr unsigned long long magnitude(long long number);
+  static constexpr bool narrow(uint128 num, uint128 den,
+                               unsigned long long *numerator,
+                               unsigned long long *denominator);
+  static constexpr unsigned long long GCD(unsigned long long num1,
+                                          unsigned long long num2);
+  static constexpr unsigned long long LCM(unsigned long long num1,
+                                          unsigned long long num2);
+  static unsigned length(unsigned long long x);
 };
 
 
+/*  The arithmetic, and everything it relies on, is defined here rather     *
+ *    than in fraction.cpp, as constexpr:  fractions built from constants,   *
+ *    and arithmetic on them, can then be computed entirely at compile time, *
+ *    as in                                                                  *
+ *      constexpr Fraction HALF(1, 2);                                       *
+ *      static_assert(HALF + Fraction(1, 3) == Fraction(5, 6), "");          *
+ *    and are otherwise inlined wherever they are used.  Only printing and   *
+ *    square roots remain in fraction.cpp.                                   *
+ */
+
+/*  The terms are read on every operation.                                   *
+ */
+constexpr bool Fraction::negative() const
+{
+  return (signAndDenominator & SIGN_BIT) != 0;
+}
+
+constexpr unsigned long long Fraction::denominator() const
+{
+  return signAndDenominator & ~SIGN_BIT;
+}
+
+
+/*  Returns the magnitude of a signed number.  Written to be safe even for   *
+ *    LLONG_MIN, whose magnitude has no positive long long representation.  *
+ */
+constexpr unsigned long long Fraction::magnitude(long long number)
+{
+  return (number < 0) ? 0ULL - (unsigned long long)number : number;
+}
+
+
+/*  Narrows a reduced 128-bit numerator and denominator into the given       *
+ *    terms.  Returns false, leaving the terms untouched, if either does not *
+ *    fit (the denominator has one bit fewer, see the notes above); the      *
+ *    caller should then signal overflow.                                    *
+ */
+constexpr bool Fraction::narrow(uint128 num, uint128 den,
+                                unsigned long long *numerator,
+                                unsigned long long *denominator)
+{
+  if ((num >> 64) != 0 || den > MAX_DENOMINATOR) return false;
+  *numerator = (unsigned long long)num;
+  *denominator = (unsigned long long)den;
+  return true;
+}
+
+
+/* Default constructor sets fraction to zero.                                *
+ */
+constexpr Fraction::Fraction() : numerator(0), signAndDenominator(1)
+{
+}
+
+
+/*  Sets the fraction to be the given number.                                *
+ */
+constexpr Fraction::Fraction(long long number)
+  : numerator(0), signAndDenominator(1)
+{
+  setTerms(number < 0, magnitude(number), 1);
+}
+
+
+/*  Sets the fraction to be (numerator/denominator), properly reduced        * 
+ */
+constexpr Fraction::Fraction(long long numerator, long long denominator)
+  : numerator(0), signAndDenominator(1)
+{
+  /* Equivalent to logical XOR; negative iff exactly one is negative  */
+  bool negative = ((numerator < 0) != (denominator < 0));
+  unsigned long long num = magnitude(numerator);
+  unsigned long long den = magnitude(denominator);
+  reduce(&num, &den);
+  if (den == 0 || den > MAX_DENOMINATOR) {  /* Only LLONG_MIN is too large */
+    setNan();
+  } else {
+    setTerms(negative, num, den);
+  }
+}
+
+
+/*-------------NEEDS TESTING----------------*/
+/*  Sets the fraction based on the given mixed number.                       *
+ *  If the whole number is negative, it signifies that the entire fraction is*
+ *    negative.  If this is not the desired behavior, make use of arithmetic *
+ *    instead.                                                               *
+ *  A mixed number too large to represent is nan.                            *
+ */
+constexpr Fraction::Fraction(long long number, unsigned long long numerator,
+                             unsigned long long denominator)
+  : numerator(0), signAndDenominator(1)
+{
+  if (denominator == 0) {
+    setNan();
+    return;
+  }
+  reduce(&numerator, &denominator);
+  uint128 total_numerator = (uint128)magnitude(number) * denominator;
+  total_numerator += numerator;
+  unsigned long long num = 0, den = 0;
+  if (!narrow(total_numerator, denominator, &num, &den)) {
+    setNan();
+  } else {
+    setTerms(number < 0, num, den);
+  }
+}
+
+
+constexpr unsigned long long Fraction::getNumerator() const
+{
+  return numerator;
+}
+
+
+constexpr unsigned long long Fraction::getDenominator() const
+{
+  return denominator();
+}
+
+
+/*  Zero and nan are never stored with the sign bit set.                     *
+ */
+constexpr bool Fraction::isNegative() const
+{
+  return negative();
+}
+
+
+constexpr bool Fraction::isNan() const
+{
+  return signAndDenominator == 0;
+}
+
+
+constexpr Fraction Fraction::operator=(long long rhs)
+{
+  setTerms(rhs < 0, magnitude(rhs), 1);
+  return *this;
+}
+
+
+/*  Returns the negation without modifying the existing fraction.  Zero and  *
+ *    nan keep their one canonical sign.                                     *
+ */
+constexpr Fraction Fraction::operator-() const
+{
+  Fraction result(*this);
+  if (numerator != 0 && !isNan()) result.signAndDenominator ^= SIGN_BIT;
+  return result;
+}
+
+
+/*  Operations with integers are the same as with the equivalent fraction;   *
+ *    since an integer has a denominator of 1, they take the fast paths      *
+ *    below.                                                                 *
+ */
+constexpr Fraction Fraction::operator*=(long long rhs)
+{
+  return operator*=(Fraction(rhs));
+}
+
+
+constexpr Fraction Fraction::operator*=(const Fraction &rhs)
+{
+  if (rhs.isNan()) {
+    setNan();
+    return *this;
+  }
+  multiply(rhs.negative(), rhs.numerator, rhs.denominator());
+  return *this;
+}
+
+
+constexpr Fraction Fraction::operator/=(long long rhs)
+{
+  return operator/=(Fraction(rhs));
+}
+
+
+/*  Division is multiplication by the reciprocal; dividing by zero is nan.   *
+ *  The reciprocal's terms are passed along directly, since its denominator  *
+ *    may be too large to store until the product has been reduced.          *
+ */
+constexpr Fraction Fraction::operator/=(const Fraction &rhs)
+{
+  if (rhs.numerator == 0 || rhs.isNan()) {
+    setNan();
+    return *this;
+  }
+  multiply(rhs.negative(), rhs.denominator(), rhs.numerator);
+  return *this;
+}
+
+
+constexpr Fraction Fraction::operator+=(long long rhs)
+{
+  return operator+=(Fraction(rhs));
+}
+
+
+/*  Uses the method from Knuth (TAOCP vol. 2, 4.5.1) to keep intermediates   *
+ *    small: with g = GCD(b, d),                                             *
+ *      a/b + c/d = (a*(d/g) + c*(b/g)) / ((b/g) * d)                        *
+ *    and the only common factors the sum t can share with that denominator  *
+ *    are factors of g, so the result is reduced by GCD(t, g) alone.         *
+ *  The cross products are formed at 128 bits.  Must account for three cases:*
+ *  -Adding a fraction of the same sign                                      *
+ *  -Adding a fraction of a different sign, greater magnitude                *
+ *  -Adding a fraction of a different sign, lesser magnitude                 *
+ */
+constexpr Fraction Fraction::operator+=(const Fraction &rhs)
+{
+  if (isNan() || rhs.isNan()) {
+    setNan();
+    return *this;
+  }
+  unsigned long long lhsDen = denominator();
+  unsigned long long rhsDen = rhs.denominator();
+  bool negative = this->negative();
+  unsigned long long g = 1;
+  if (lhsDen != 1 && rhsDen != 1) {
+    g = GCD(lhsDen, rhsDen);
+  }
+  uint128 lhsTerm = (uint128)numerator * (rhsDen / g);
+  uint128 rhsTerm = (uint128)rhs.numerator * (lhsDen / g);
+  uint128 sum = 0;
+  if (rhs.negative() == negative) {
+    sum = lhsTerm + rhsTerm;
+    if (sum < lhsTerm) {             /* Wrapped; far too large to narrow */
+      setNan();
+      return *this;
+    }
+  } else if (rhsTerm > lhsTerm) {
+    sum = rhsTerm - lhsTerm;
+    negative = !negative;
+  } else {
+    sum = lhsTerm - rhsTerm;
+  }
+  if (sum == 0) {
+    *this = 0;
+    return *this;
+  }
+  unsigned long long common = 1;
+  if (g != 1) common = GCD((unsigned long long)(sum % g), g);
+  if (common != 1) sum /= common;
+  uint128 den = (uint128)(lhsDen / g) * (rhsDen / common);
+  unsigned long long num = 0, newDen = 0;
+  if (!narrow(sum, den, &num, &newDen)) {
+    setNan();
+  } else {
+    setTerms(negative, num, newDen);
+  }
+  return *this;
+}
+
+constexpr Fraction Fraction::operator-=(long long rhs)
+{
+  return operator-=(Fraction(rhs));
+}
+
+constexpr Fraction Fraction::operator-=(const Fraction &rhs)
+{
+  return operator+=(-rhs);
+}
+
+/*  Fractions are always in lowest terms, and zero and nan have one form     *
+ *    each, so equal fractions are stored identically.                       *
+ */
+constexpr bool Fraction::operator==(const Fraction &rhs) const
+{
+  return (numerator == rhs.numerator &&
+          signAndDenominator == rhs.signAndDenominator);
+}
+
+/* Must account for four cases:                                              *
+ * -Zero (denominator may be anything but zero, which signals nan)           *
+ * -Non-integer (cannot equal an integer)                                    *
+ * -Positive and negative numbers                                            *
+ */
+constexpr bool Fraction::operator==(long long rhs) const
+{
+  return *this == Fraction(rhs);
+}
+
+
+constexpr bool Fraction::operator<(long long rhs) const
+{
+  return operator<(Fraction(rhs));
+}
+
+
+/*  Compares without subtracting, which would need a GCD and could overflow. *
+ *  Fractions of differing sign are ordered by sign alone.  Otherwise, since *
+ *    both denominators are positive, a/b < c/d exactly when a*d < c*b, and  *
+ *    those products are formed at 128 bits, where they cannot wrap.  For    *
+ *    negative fractions the comparison of magnitudes is reversed.           *
+ */
+constexpr bool Fraction::operator<(const Fraction &rhs) const
+{
+  if (isNan() || rhs.isNan()) return false;
+  bool lhsNegative = negative();
+  bool rhsNegative = rhs.negative();
+  if (lhsNegative != rhsNegative) return lhsNegative;
+  uint128 lhsCross = numerator;
+  uint128 rhsCross = rhs.numerator;
+  if (signAndDenominator != rhs.signAndDenominator) {
+    lhsCross *= rhs.denominator();
+    rhsCross *= denominator();
+  }
+  return lhsNegative ? (rhsCross < lhsCross) : (lhsCross < rhsCross);
+}
+
+
+/*  Returns the result of raising the current fraction to the given integer  *
+ *    exponent, by repeated squaring:  the base is squared once per bit of   *
+ *    the exponent, and multiplied into the result for each bit that is set, *
+ *    so only O(log exp) multiplications are needed.                         *
+ *  A negative exponent raises the reciprocal instead.                       *
+ *  Does not modify the existing fraction.                                   *
+ */
+constexpr Fraction Fraction::power(int exp) const
+{
+  Fraction result(1);
+  Fraction base = (exp < 0) ? reciprocal() : *this;
+  unsigned remaining = (exp < 0) ? 0U - (unsigned)exp : exp;
+  while (remaining > 0) {
+    if (remaining & 1) result *= base;
+    remaining >>= 1;
+    if (remaining > 0) base *= base;
+  }
+  return result;
+}
+
+
+/*  Returns the reciprocal without modifying the existing fraction.  The     *
+ *    reciprocal of a numerator too large to be a denominator is nan.        *
+ */
+constexpr Fraction Fraction::reciprocal() const
+{
+  Fraction result;
+  if (numerator == 0 || isNan() || numerator > MAX_DENOMINATOR) {
+    result.setNan();
+  } else {
+    result.setTerms(negative(), denominator(), numerator);
+  }
+  return result;
+}
+
+
+/*  The best approximations with bounded denominators are found among the   *
+ *    convergents p/q of the continued fraction n/d = [a0; a1, a2, ...],     *
+ *      p' = a*p + pPrev,  q' = a*q + qPrev                                  *
+ *    and the semiconvergents between them.  The convergents are followed   *
+ *    until the next denominator would pass the limit; the answer is then    *
+ *    either the last convergent, or the semiconvergent with the largest     *
+ *    denominator within the limit, whichever is closer (the method of       *
+ *    Python's Fraction.limit_denominator).                                  *
+ *  Convergents are in lowest terms, and never exceed the original terms,    *
+ *    so no reduction or overflow checks are needed.  The distances compare  *
+ *    as the remainders |p*d - n*q|, weighted by the other denominator.      *
+ */
+constexpr Fraction Fraction::limitDenominator(unsigned long long limit) const
+{
+  Fraction result;
+  if (isNan() || limit == 0) {
+    result.setNan();
+    return result;
+  }
+  unsigned long long d = denominator();
+  if (d <= limit) return *this;
+  unsigned long long n = numerator;
+  unsigned long long p = 1, pPrev = 0;
+  unsigned long long q = 0, qPrev = 1;
+  unsigned long long num = n, den = d;
+  while (true) {
+    unsigned long long a = num / den;
+    uint128 qNext = (uint128)a * q + qPrev;
+    if (qNext > limit) break;
+    unsigned long long pNext = a * p + pPrev;
+    pPrev = p;
+    p = pNext;
+    qPrev = q;
+    q = (unsigned long long)qNext;
+    unsigned long long remainder = num - a * den;
+    num = den;
+    den = remainder;
+  }
+  unsigned long long k = (limit - qPrev) / q;
+  unsigned long long semiNum = pPrev + k * p;
+  unsigned long long semiDen = qPrev + k * q;
+  uint128 convergentError = (uint128)p * d - (uint128)n * q;
+  if ((uint128)n * q > (uint128)p * d) {
+    convergentError = (uint128)n * q - (uint128)p * d;
+  }
+  uint128 semiError = (uint128)semiNum * d - (uint128)n * semiDen;
+  if ((uint128)n * semiDen > (uint128)semiNum * d) {
+    semiError = (uint128)n * semiDen - (uint128)semiNum * d;
+  }
+  uint128 convergentDistance = convergentError * semiDen;
+  uint128 semiDistance = semiError * q;
+  if (convergentDistance < semiDistance ||
+      (convergentDistance == semiDistance && q < semiDen)) {
+    result.setTerms(negative(), p, q);
+  } else {
+    result.setTerms(negative(), semiNum, semiDen);
+  }
+  return result;
+}
+
+
+/*  Marks the fraction as nan, in its one canonical form, 1/0.               *
+ */
+constexpr void Fraction::setNan()
+{
+  numerator = 1;
+  signAndDenominator = 0;
+}
+
+
+/*  Stores the given terms, which must already be in lowest terms, with a    *
+ *    denominator no larger than MAX_DENOMINATOR.  Zero is never negative.   *
+ */
+constexpr void Fraction::setTerms(bool negative,
+                                  unsigned long long numerator,
+                                  unsigned long long denominator)
+{
+  this->numerator = numerator;
+  signAndDenominator = denominator;
+  if (negative && numerator != 0) signAndDenominator |= SIGN_BIT;
+}
+
+
+/*  Multiplies the fraction by (sign) num/den, given in lowest terms; den    *
+ *    may be the full 64 bits wide, as when dividing.                        *
+ *  Each numerator is reduced against the other denominator first.  Since    *
+ *    both fractions were already in lowest terms, the product is then in    *
+ *    lowest terms as well, so if it does not fit, nothing could make it.    *
+ */
+constexpr void Fraction::multiply(bool negative, unsigned long long num,
+                                  unsigned long long den)
+{
+  if (isNan()) return;
+  unsigned long long lhsNum = numerator;
+  unsigned long long lhsDen = denominator();
+  reduce(&lhsNum, &den);
+  reduce(&num, &lhsDen);
+  unsigned long long newNum = 0, newDen = 0;
+  if (!narrow((uint128)lhsNum * num, (uint128)lhsDen * den,
+              &newNum, &newDen)) {
+    setNan();
+    return;
+  }
+  setTerms(this->negative() != negative, newNum, newDen);
+}
+
+
+/*  Reduces the given numbers by dividing out their greatest common divisor.*
+ *  Takes the numbers by reference, modifying both (if necessary).           *
+ *  Numbers of 1 are the common case (integers), and can never be reduced,   *
+ *    so they skip the GCD entirely.                                         *
+ */
+constexpr void Fraction::reduce(unsigned long long *num1,
+                                unsigned long long *num2)
+{
+  unsigned long long n1 = *num1;
+  unsigned long long n2 = *num2;
+  if (n1 == 1 || n2 == 1) return;
+  unsigned long long divisor = GCD(n1, n2);
+  if (divisor > 1) {
+    *num1 = n1 / divisor;
+    *num2 = n2 / divisor;
+  }
+}
+
+
+/*  Returns the Least Common Multiple of the given two numbers.              *
+ *  Takes advantage of the fact LCM(a,b) == |a*b|/GCD(a,b)                   *
+ *  Takes unsigned numbers, so no need to worry about absolute value.        *
+ *  Order of caluclations is to make overflow less likely.                   *
+ */
+constexpr unsigned long long Fraction::LCM(unsigned long long num1,
+                                           unsigned long long num2)
+{
+  if (num1 == 1) return num2;
+  if (num2 == 1) return num1;
+  return (num1 / GCD(num1, num2)) * num2;
+}
+
+
+/*  Returns the Greatest Common Divisor of the given two numbers.            *
+ *  Utilizes the binary (Stein's) algorithm, iteratively, on the full 64-bit *
+ *    width: common factors of two are counted once up front, and each step  *
+ *    subtracts the smaller odd number from the larger, then shifts out the  *
+ *    factors of two that the subtraction produced.  This needs no division, *
+ *    and no more steps than there are bits in the two numbers.              *
+ *  GCD(0, x) is x, as usual.                                                *
+ */
+constexpr unsigned long long Fraction::GCD(unsigned long long num1,
+                                           unsigned long long num2)
+{
+  if (num1 == 0) return num2;
+  if (num2 == 0) return num1;
+  int shift = __builtin_ctzll(num1 | num2);
+  num1 >>= __builtin_ctzll(num1);
+  do {
+    num2 >>= __builtin_ctzll(num2);
+    unsigned long long smaller = (num1 < num2) ? num1 : num2;
+    num2 = (num1 < num2 ? num2 : num1) - smaller;
+    num1 = smaller;
+  } while (num2 != 0);
+  return num1 << shift;
+}
+
+
 
 /*  The following define further arithmetic operators in terms of the        *
  *    assignment operators already declared within the class.                *
  *  They are defined so that arithmetic may proceed between integers and     *
  *    fractions in any order.                                                *
  */
-inline Fraction operator*(Fraction lhs, long long rhs)
+constexpr Fraction operator*(Fraction lhs, long long rhs)
 {
   lhs *= rhs;
   return lhs;
 }
 
-inline Fraction operator*(long long lhs, Fraction rhs)
+constexpr Fraction operator*(long long lhs, const Fraction &rhs)
 {
   return rhs * lhs;
 }
 
-inline Fraction operator*(Fraction lhs, Fraction rhs)
+constexpr Fraction operator*(Fraction lhs, const Fraction &rhs)
 {
   lhs *= rhs;
   return lhs;
 }
 
-inline Fraction operator/(Fraction lhs, long long rhs)
+constexpr Fraction operator/(Fraction lhs, long long rhs)
 {
   lhs /= rhs;
   return lhs;
 }
 
-inline Fraction operator/(Fraction lhs, Fraction rhs)
+constexpr Fraction operator/(Fraction lhs, const Fraction &rhs)
 {
   lhs /= rhs;
   return lhs;
 }
 
-inline Fraction operator/(long long lhs, Fraction rhs)
+constexpr Fraction operator/(long long lhs, const Fraction &rhs)
 {
   Fraction temp(lhs);
   return temp / rhs;
 }
 
-inline Fraction operator+(Fraction lhs, long long rhs)
+constexpr Fraction operator+(Fraction lhs, long long rhs)
 {
   lhs += rhs;
   return lhs;
 }
 
-inline Fraction operator+(long long lhs, Fraction rhs)
+constexpr Fraction operator+(long long lhs, Fraction rhs)
 {
   rhs += lhs;
   return rhs;
 }
 
-inline Fraction operator+(Fraction lhs, Fraction rhs)
+constexpr Fraction operator+(Fraction lhs, const Fraction &rhs)
 {
   lhs += rhs;
   return lhs;
 }
 
-inline Fraction operator-(Fraction lhs, long long rhs)
+constexpr Fraction operator-(Fraction lhs, long long rhs)
 {
-  lhs += -rhs;
+  lhs -= rhs;
   return lhs;
 }
 
-inline Fraction operator-(Fraction lhs, Fraction rhs)
+constexpr Fraction operator-(Fraction lhs, const Fraction &rhs)
 {
-  lhs += -rhs;
+  lhs -= rhs;
   return lhs;
 }
 
-inline Fraction operator-(long long lhs, Fraction rhs)
+constexpr Fraction operator-(long long lhs, const Fraction &rhs)
 {
-  rhs = lhs + -rhs;
-  return rhs;
+  return lhs + -rhs;
 }
 
 
@@ -193,74 +788,74 @@ inline Fraction operator-(long long lhs, Fraction rhs)
  *    operators already implemented within the class.                        *
  *  Comparisons may be made between fractions and integers in any order.     *
  */
-inline bool operator==(long long lhs, Fraction rhs)
+constexpr bool operator==(long long lhs, const Fraction &rhs)
 {
   return rhs == lhs;
 }
 
-inline bool operator!=(Fraction lhs, long long rhs)
+constexpr bool operator!=(const Fraction &lhs, long long rhs)
 {
   return !(lhs == rhs);
 }
 
-inline bool operator!=(long long lhs, Fraction rhs)
+constexpr bool operator!=(long long lhs, const Fraction &rhs)
 {
   return !(rhs == lhs);
 }
 
-inline bool operator!=(Fraction lhs, Fraction rhs)
+constexpr bool operator!=(const Fraction &lhs, const Fraction &rhs)
 {
   return !(lhs == rhs);
 }
 
-inline bool operator>(long long lhs, Fraction rhs)
+constexpr bool operator<(long long lhs, const Fraction &rhs)
 {
-  return rhs < lhs;
+  return Fraction(lhs) < rhs;
 }
 
-inline bool operator>(Fraction lhs, Fraction rhs)
+constexpr bool operator>(const Fraction &lhs, const Fraction &rhs)
 {
   return rhs < lhs;
 }
 
-inline bool operator<=(Fraction lhs, Fraction rhs)
+constexpr bool operator>(const Fraction &lhs, long long rhs)
 {
-  return !(lhs > rhs);
+  return rhs < lhs;
 }
 
-inline bool operator<=(long long lhs, Fraction rhs)
+constexpr bool operator>(long long lhs, const Fraction &rhs)
 {
-  return !(lhs > rhs);
+  return rhs < lhs;
 }
 
-inline bool operator>=(Fraction lhs, long long rhs)
+constexpr bool operator<=(const Fraction &lhs, const Fraction &rhs)
 {
-  return !(lhs < rhs);
+  return !lhs.isNan() && !rhs.isNan() && !(rhs < lhs);
 }
 
-inline bool operator>=(Fraction lhs, Fraction rhs)
+constexpr bool operator<=(const Fraction &lhs, long long rhs)
 {
-  return !(lhs < rhs);
+  return !lhs.isNan() && !(rhs < lhs);
 }
 
-inline bool operator<=(Fraction lhs, long long rhs)
+constexpr bool operator<=(long long lhs, const Fraction &rhs)
 {
-  return (lhs < rhs) || (lhs == rhs);
+  return !rhs.isNan() && !(rhs < lhs);
 }
 
-inline bool operator>(Fraction lhs, long long rhs)
+constexpr bool operator>=(const Fraction &lhs, const Fraction &rhs)
 {
-  return !(lhs <= rhs);
+  return !lhs.isNan() && !rhs.isNan() && !(lhs < rhs);
 }
 
-inline bool operator>=(long long lhs, Fraction rhs)
+constexpr bool operator>=(const Fraction &lhs, long long rhs)
 {
-  return rhs <= lhs;
+  return !lhs.isNan() && !(lhs < rhs);
 }
 
-inline bool operator<(long long lhs, Fraction rhs)
+constexpr bool operator>=(long long lhs, const Fraction &rhs)
 {
-  return !(lhs >= rhs);
+  return !rhs.isNan() && !(lhs < rhs);
 }
 
 #endif
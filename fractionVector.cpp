@@ -0,0 +1,377 @@
+/*---------------------------------------------------------------------------*\
+ *                             fractionVector.cpp                            *
+ *                  Implementation of the FractionVector class               *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    The three arrays share one aligned block, each padded to a whole       *
+ *      number of LANES entries.  Padding entries are kept as 0/1, so the    *
+ *      batch kernels may run over them freely.                              *
+ *    The batch kernels are written with the compiler's vector extensions,   *
+ *      LANES entries at a time.  On x86-64 Linux, each is compiled twice,   *
+ *      for AVX2 and for the baseline SSE2, and the version the processor    *
+ *      supports is picked when the program loads; elsewhere the compiler    *
+ *      lowers them to whatever the target has, or to plain scalar code.     *
+\*---------------------------------------------------------------------------*/
+#include<new>
+#include "fraction.h"
+#include "fractionVector.h"
+using namespace std;
+
+typedef unsigned long long Lanes __attribute__((vector_size(32)));
+static const int LANES = 4;
+static const size_t ALIGNMENT = 32;
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__)
+#define BATCH_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define BATCH_KERNEL
+#endif
+
+/*  Entries whose magnitudes are below 2^31 multiply to below 2^62, and two  *
+ *    such products, or two magnitudes below 2^62, add to below 2^63; the    *
+ *    small-integer kernels rely on this to work in signed 64-bit lanes.     *
+ */
+static const int FACTOR_BITS = 31;
+static const int TERM_BITS = 62;
+
+
+/*  Reinterprets an aligned array as groups of LANES entries.                */
+static Lanes *groups(unsigned long long *p)
+{
+  return (Lanes *)p;
+}
+
+static const Lanes *groups(const unsigned long long *p)
+{
+  return (const Lanes *)p;
+}
+
+
+/*  Returns whether the fraction is an integer that fits the small-integer   *
+ *    kernels as a factor, and if so its magnitude and sign.                 *
+ */
+static bool smallFactor(const Fraction &factor, unsigned long long *magnitude,
+			unsigned long long *sign)
+{
+  if (factor.getDenominator() != 1 ||
+      (factor.getNumerator() >> FACTOR_BITS) != 0) {
+    return false;
+  }
+  *magnitude = factor.getNumerator();
+  *sign = factor.isNegative() ? ~0ULL : 0;
+  return true;
+}
+
+
+/*  The small-integer kernels.  Each works through the groups of LANES      *
+ *    entries from begin, for as long as every entry in a group is a small   *
+ *    integer, and returns where it stopped: end, or the start of a group    *
+ *    that must be done entry by entry.                                      *
+ *  Signs are masks, so a product's sign is an exclusive or, and a signed    *
+ *    magnitude m becomes two's complement as (m ^ sign) - sign.             *
+ */
+BATCH_KERNEL
+static int scaleLanes(unsigned long long *num, const unsigned long long *den,
+		      unsigned long long *sign, int begin, int end,
+		      unsigned long long factor, unsigned long long factorSign)
+{
+  Lanes *n = groups(num), *s = groups(sign);
+  const Lanes *d = groups(den);
+  int g;
+  for (g = begin / LANES; g < end / LANES; g++) {
+    Lanes large = (d[g] ^ 1) | (n[g] >> FACTOR_BITS);
+    if (large[0] | large[1] | large[2] | large[3]) break;
+    n[g] *= factor;
+    s[g] = (s[g] ^ factorSign) & (Lanes)(n[g] != 0);
+  }
+  return g * LANES;
+}
+
+
+BATCH_KERNEL
+static int multiplyLanes(unsigned long long *num, const unsigned long long *den,
+			 unsigned long long *sign,
+			 const unsigned long long *rhsNum,
+			 const unsigned long long *rhsDen,
+			 const unsigned long long *rhsSign, int begin, int end)
+{
+  Lanes *n = groups(num), *s = groups(sign);
+  const Lanes *d = groups(den);
+  const Lanes *rn = groups(rhsNum), *rd = groups(rhsDen), *rs = groups(rhsSign);
+  int g;
+  for (g = begin / LANES; g < end / LANES; g++) {
+    Lanes large = (d[g] ^ 1) | (rd[g] ^ 1) | ((n[g] | rn[g]) >> FACTOR_BITS);
+    if (large[0] | large[1] | large[2] | large[3]) break;
+    n[g] *= rn[g];
+    s[g] = (s[g] ^ rs[g]) & (Lanes)(n[g] != 0);
+  }
+  return g * LANES;
+}
+
+
+/*  Adds rhs * factor to each entry; add() is the case of a factor of one.   */
+BATCH_KERNEL
+static int addScaledLanes(unsigned long long *num,
+			  const unsigned long long *den,
+			  unsigned long long *sign,
+			  const unsigned long long *rhsNum,
+			  const unsigned long long *rhsDen,
+			  const unsigned long long *rhsSign, int begin, int end,
+			  unsigned long long factor, unsigned long long factorSign)
+{
+  Lanes *n = groups(num), *s = groups(sign);
+  const Lanes *d = groups(den);
+  const Lanes *rn = groups(rhsNum), *rd = groups(rhsDen), *rs = groups(rhsSign);
+  int g;
+  for (g = begin / LANES; g < end / LANES; g++) {
+    Lanes large = (d[g] ^ 1) | (rd[g] ^ 1) | (n[g] >> TERM_BITS) |
+      (rn[g] >> FACTOR_BITS);
+    if (large[0] | large[1] | large[2] | large[3]) break;
+    Lanes termSign = rs[g] ^ factorSign;
+    Lanes sum = ((n[g] ^ s[g]) - s[g]) +
+      ((rn[g] * factor ^ termSign) - termSign);
+    s[g] = -(sum >> 63);
+    n[g] = (sum ^ s[g]) - s[g];
+  }
+  return g * LANES;
+}
+
+
+/*  Constructors                                                             */
+FractionVector::FractionVector()
+{
+  allocate(0);
+}
+
+
+FractionVector::FractionVector(int size)
+{
+  allocate(size);
+  for (int i = 0; i < count; i++) {
+    numerators[i] = 0;
+    denominators[i] = 1;
+    signs[i] = 0;
+  }
+}
+
+
+FractionVector::FractionVector(const Fraction *values, int size)
+{
+  allocate(size);
+  for (int i = 0; i < count; i++) {
+    setEntry(i, values[i]);
+  }
+}
+
+
+FractionVector::FractionVector(const FractionVector &rval)
+{
+  allocate(rval.count);
+  for (int i = 0; i < 3 * padded; i++) {
+    numerators[i] = rval.numerators[i];
+  }
+}
+
+
+FractionVector &FractionVector::operator=(const FractionVector &rval)
+{
+  if (this != &rval) {
+    release();
+    allocate(rval.count);
+    for (int i = 0; i < 3 * padded; i++) {
+      numerators[i] = rval.numerators[i];
+    }
+  }
+  return *this;
+}
+
+
+FractionVector::~FractionVector()
+{
+  release();
+}
+
+
+int FractionVector::size() const
+{
+  return count;
+}
+
+
+Fraction FractionVector::get(int index) const
+{
+  Fraction result;
+  if (index >= 0 && index < count) {
+    result = entry(index);
+  } else {
+    result.setNan();
+  }
+  return result;
+}
+
+
+void FractionVector::set(int index, const Fraction &value)
+{
+  if (index >= 0 && index < count) {
+    setEntry(index, value);
+  }
+}
+
+
+/*  Zero and nan are given their canonical forms right away, so that        *
+ *    reduce only ever has GCDs to take.                                     *
+ */
+void FractionVector::set(int index, bool negative,
+			 unsigned long long numerator,
+			 unsigned long long denominator)
+{
+  if (index < 0 || index >= count) return;
+  if (denominator == 0) {
+    numerator = 1;
+    negative = false;
+  } else if (numerator == 0) {
+    denominator = 1;
+    negative = false;
+  }
+  numerators[index] = numerator;
+  denominators[index] = denominator;
+  signs[index] = negative ? ~0ULL : 0;
+}
+
+
+void FractionVector::store(Fraction *values) const
+{
+  for (int i = 0; i < count; i++) {
+    values[i] = entry(i);
+  }
+}
+
+
+/*  Each batch operation hands runs of small integers to its kernel, and     *
+ *    does any group of LANES entries that the kernel stops at one entry at  *
+ *    a time, with Fraction's own arithmetic.                                *
+ */
+FractionVector &FractionVector::scale(const Fraction &factor)
+{
+  unsigned long long magnitude, sign;
+  bool small = smallFactor(factor, &magnitude, &sign);
+  for (int i = 0; i < padded; i += LANES) {
+    if (small) {
+      i = scaleLanes(numerators, denominators, signs, i, padded,
+		     magnitude, sign);
+      if (i == padded) break;
+    }
+    for (int j = i; j < i + LANES && j < count; j++) {
+      setEntry(j, entry(j) * factor);
+    }
+  }
+  return *this;
+}
+
+
+FractionVector &FractionVector::multiply(const FractionVector &rhs)
+{
+  if (rhs.count != count) return *this;
+  for (int i = 0; i < padded; i += LANES) {
+    i = multiplyLanes(numerators, denominators, signs, rhs.numerators,
+		      rhs.denominators, rhs.signs, i, padded);
+    if (i == padded) break;
+    for (int j = i; j < i + LANES && j < count; j++) {
+      setEntry(j, entry(j) * rhs.entry(j));
+    }
+  }
+  return *this;
+}
+
+
+FractionVector &FractionVector::add(const FractionVector &rhs)
+{
+  return addScaled(rhs, 1);
+}
+
+
+/*  Entries of rhs that are zero add nothing, unless the factor is nan, and  *
+ *    are skipped; once a row has been partly eliminated, many of them are.  *
+ */
+FractionVector &FractionVector::addScaled(const FractionVector &rhs,
+					  const Fraction &factor)
+{
+  if (rhs.count != count) return *this;
+  unsigned long long magnitude, sign;
+  bool small = smallFactor(factor, &magnitude, &sign);
+  bool skipZeros = !factor.isNan();
+  for (int i = 0; i < padded; i += LANES) {
+    if (small) {
+      i = addScaledLanes(numerators, denominators, signs, rhs.numerators,
+			 rhs.denominators, rhs.signs, i, padded,
+			 magnitude, sign);
+      if (i == padded) break;
+    }
+    for (int j = i; j < i + LANES && j < count; j++) {
+      if (!skipZeros || rhs.numerators[j] != 0 || rhs.denominators[j] == 0) {
+	Fraction sum = entry(j);
+	sum += rhs.entry(j) * factor;
+	setEntry(j, sum);
+      }
+    }
+  }
+  return *this;
+}
+
+
+/*  Integers, the common case, are already in lowest terms, and are passed  *
+ *    over.  A denominator that is still too large once reduced is nan, as   *
+ *    it would be for a Fraction.                                            *
+ */
+FractionVector &FractionVector::reduce()
+{
+  for (int i = 0; i < count; i++) {
+    unsigned long long num = numerators[i], den = denominators[i];
+    if (den == 1 || den == 0) continue;
+    unsigned long long divisor = Fraction::GCD(num, den);
+    num /= divisor;
+    den /= divisor;
+    if (den > Fraction::MAX_DENOMINATOR) {
+      set(i, false, 1, 0);
+    } else {
+      numerators[i] = num;
+      denominators[i] = den;
+    }
+  }
+  return *this;
+}
+
+
+/*  Takes one aligned block for all three arrays, and fills in the padding  *
+ *    past the last entry; the entries themselves are left to the caller.    *
+ *  Short vectors, like the rows of most matrices typed in by hand, use the  *
+ *    block within the object instead of the heap.                           *
+ */
+void FractionVector::allocate(int size)
+{
+  count = (size > 0) ? size : 0;
+  padded = (count + LANES - 1) / LANES * LANES;
+  if (padded <= INLINE_ENTRIES) {
+    numerators = inlineTerms;
+  } else {
+    numerators = static_cast<unsigned long long *>
+      (::operator new[](3 * padded * sizeof(unsigned long long),
+			align_val_t(ALIGNMENT)));
+  }
+  denominators = numerators + padded;
+  signs = denominators + padded;
+  for (int i = count; i < padded; i++) {
+    numerators[i] = 0;
+    denominators[i] = 1;
+    signs[i] = 0;
+  }
+}
+
+
+void FractionVector::release()
+{
+  if (numerators != inlineTerms) {
+    ::operator delete[](numerators, align_val_t(ALIGNMENT));
+  }
+  numerators = denominators = signs = NULL;
+}
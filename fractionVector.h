@@ -0,0 +1,115 @@
+/*---------------------------------------------------------------------------*\
+ *                              fractionVector.h                             *
+ *                   Interface for the FractionVector class                  *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Holds a row of fractions laid out for batch arithmetic: numerators,    *
+ *      denominators and signs each in an array of their own, rather than    *
+ *      one Fraction after another.                                          *
+ *    Operations apply to the whole vector at once, element by element, so   *
+ *      that row operations on a matrix take one call per row rather than    *
+ *      one per entry.                                                       *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Results are exactly those that Fraction's own operators would give,    *
+ *      including nan on overflow.                                           *
+ *   -The arrays are aligned, and padded to a whole number of SIMD lanes.    *
+ *      Runs of small integers (denominator 1, magnitude below 2^31), the    *
+ *      common case in integer matrices, are computed several at a time      *
+ *      with AVX2 or SSE2 instructions where the processor has them.  Any    *
+ *      other entry is computed on its own, with 128-bit intermediates and   *
+ *      GCDs, as a Fraction is, since neither vectorizes.                    *
+ *   -Short vectors are kept within the object, as BigInteger keeps small    *
+ *      numbers, so they never allocate.                                     *
+\*---------------------------------------------------------------------------*/
+#ifndef FRACTIONVECTOR_CLASS_INCLUDED
+#define FRACTIONVECTOR_CLASS_INCLUDED
+#include "fraction.h"
+
+class FractionVector
+{
+ public:
+  /*  Constructors                                                           *
+   *  Default constructor creates an empty vector.                           *
+   *  Second constructor creates a vector of the given size, all zeros.      *
+   *  Third constructor copies the given array of fractions.                 *
+   */
+  FractionVector();
+  FractionVector(int size);
+  FractionVector(const Fraction *values, int size);
+
+  FractionVector(const FractionVector &rval);
+  FractionVector &operator=(const FractionVector &rval);
+  ~FractionVector();
+
+  int size() const;
+
+  /*  Get and set single entries.  Invalid indices result in set doing       *
+   *    nothing, and get returning nan.                                      *
+   *  The second form of set stores raw terms, which need not be in lowest   *
+   *    terms; call reduce() before doing arithmetic with them.              *
+   */
+  Fraction get(int index) const;
+  void set(int index, const Fraction &value);
+  void set(int index, bool negative, unsigned long long numerator,
+           unsigned long long denominator);
+
+  /*  Copies the vector back out into an array of size() fractions.          *
+   */
+  void store(Fraction *values) const;
+
+  /*  Batch arithmetic, applied to each entry in turn:                       *
+   *  -scale multiplies every entry by a single factor.                      *
+   *  -multiply and add combine entries with those of a vector of the same   *
+   *   size.                                                                 *
+   *  -addScaled adds each entry of another vector, times a factor; the row  *
+   *   operation "add a multiple of one row to another".                     *
+   *  -reduce divides every entry's terms by their GCD.                      *
+   *  Vectors of different sizes are left unchanged.                         *
+   */
+  FractionVector &scale(const Fraction &factor);
+  FractionVector &multiply(const FractionVector &rhs);
+  FractionVector &add(const FractionVector &rhs);
+  FractionVector &addScaled(const FractionVector &rhs, const Fraction &factor);
+  FractionVector &reduce();
+
+ private:
+  int count;
+  int padded;                           /* count rounded up to whole lanes */
+  unsigned long long *numerators;
+  unsigned long long *denominators;     /* 0 marks a nan entry             */
+  unsigned long long *signs;            /* All ones if negative, else 0    */
+
+  /*  Vectors of up to INLINE_ENTRIES entries, a whole number of SIMD       *
+   *    lanes, are stored here, in the object itself, rather than on the     *
+   *    heap.                                                                *
+   */
+  static const int INLINE_ENTRIES = 32;
+  alignas(32) unsigned long long inlineTerms[3 * INLINE_ENTRIES];
+
+  Fraction entry(int index) const;
+  void setEntry(int index, const Fraction &value);
+  void allocate(int size);
+  void release();
+};
+
+
+/*  Entries are converted on every operation, so these are inline.           *
+ */
+inline Fraction FractionVector::entry(int index) const
+{
+  Fraction result;
+  result.numerator = numerators[index];
+  result.signAndDenominator = denominators[index] |
+    (signs[index] & Fraction::SIGN_BIT);
+  return result;
+}
+
+inline void FractionVector::setEntry(int index, const Fraction &value)
+{
+  numerators[index] = value.numerator;
+  denominators[index] = value.denominator();
+  signs[index] = value.negative() ? ~0ULL : 0;
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*---------------------------------------------------------------------------*\
+ *                             luFactorization.cpp                           *
+ *                 Implementation of the LUFactorization class               *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    L and U share one matrix, the size of A, as the elimination leaves it: *
+ *    each row holds U's entries from its pivot on, and, in the columns of   *
+ *    the pivots above it, the multipliers that eliminated them, which are   *
+ *    L's entries below the diagonal.  L's 1s are not stored.                *
+ *    Rows are switched as the elimination goes, multipliers and all, and    *
+ *    order records where each one started.                                  *
+\*---------------------------------------------------------------------------*/
+#include<algorithm>
+#include<iostream>
+#include<string>
+#include<vector>
+#include "fraction.h"
+#include "matrix.h"
+#include "threadPool.h"
+#include "luFactorization.h"
+using namespace std;
+
+LUFactorization::LUFactorization()
+{
+  det = 1;
+}
+
+
+/*  Gaussian elimination, as in Matrix::determinant(), except that each      *
+ *    multiplier is kept where the entry it eliminated was, rather than      *
+ *    discarded.  Rows below the pivot are independent, so they are split    *
+ *    across the threads.                                                    *
+ */
+LUFactorization::LUFactorization(const Matrix &m)
+  : factors(m)
+{
+  int rows = factors.rows, cols = factors.cols;
+  for (int i = 0; i < rows; i++) {
+    order.push_back(i);
+  }
+  bool negated = false;
+  for (int j = 0; j < cols && (int)pivotCols.size() < rows; j++) {
+    int r = pivotCols.size();
+    int pivot = factors.getPivot(j, r);
+    if (pivot < 0) continue;
+    if (pivot != r) {
+      factors.switchRows(r, pivot);
+      swap(order[r], order[pivot]);
+      negated = !negated;
+    }
+    const Fraction *pivotRow = factors.rowStart(r);
+    Fraction scale = pivotRow[j].reciprocal();
+    ThreadPool::shared().parallelFor(rows - r - 1,
+				     ThreadPool::minBlock(cols - j),
+				     [&](int begin, int end) {
+      for (int i = r + 1 + begin; i < r + 1 + end; i++) {
+	Fraction *row = factors.rowStart(i);
+	if (row[j] == 0) continue;
+	Fraction multiplier = row[j] * scale;
+	row[j] = multiplier;
+	for (int k = j + 1; k < cols; k++) {
+	  row[k] -= pivotRow[k] * multiplier;
+	}
+      }
+    });
+    pivotCols.push_back(j);
+  }
+
+  if (rows != cols) {
+    det = Fraction(1, 0);
+  } else if (rank() < rows) {
+    det = 0;
+  } else {
+    det = negated ? -1 : 1;
+    for (int i = 0; i < rows; i++) {
+      det *= factors.rowStart(i)[i];
+    }
+  }
+}
+
+
+int LUFactorization::getRows() const
+{
+  return factors.rows;
+}
+
+
+int LUFactorization::getCols() const
+{
+  return factors.cols;
+}
+
+
+int LUFactorization::rank() const
+{
+  return pivotCols.size();
+}
+
+
+Fraction LUFactorization::determinant() const
+{
+  return det;
+}
+
+
+/*  Since PA = LU, Ax = b exactly when L(Ux) = Pb.  So each column of Pb is  *
+ *    solved for y = Ux by substituting forward through L, and then for x by *
+ *    substituting backward through U.  Columns are independent, so they     *
+ *    are split across the threads.                                          *
+ */
+Matrix LUFactorization::solve(const Matrix &b) const
+{
+  int size = factors.rows;
+  if (size != factors.cols || rank() < size || b.rows != size ||
+      size == 0) {
+    return Matrix();
+  }
+  Matrix x(size, b.cols);
+  int minBlock = ThreadPool::minBlock((long long)size * size);
+  ThreadPool::shared().parallelFor(b.cols, minBlock, [&](int begin, int end) {
+    vector<Fraction> y(size);
+    for (int c = begin; c < end; c++) {
+      for (int i = 0; i < size; i++) {
+	const Fraction *row = factors.rowStart(i);
+	Fraction sum = b.rowStart(order[i])[c];
+	for (int k = 0; k < i; k++) {
+	  sum -= row[k] * y[k];
+	}
+	y[i] = sum;
+      }
+      for (int i = size - 1; i >= 0; i--) {
+	const Fraction *row = factors.rowStart(i);
+	Fraction sum = y[i];
+	for (int k = i + 1; k < size; k++) {
+	  sum -= row[k] * y[k];
+	}
+	y[i] = sum / row[i];
+	x.rowStart(i)[c] = y[i];
+      }
+    }
+  });
+  return x;
+}
+
+
+Matrix LUFactorization::permutation() const
+{
+  Matrix result(factors.rows, factors.rows);
+  for (int i = 0; i < factors.rows; i++) {
+    result.rowStart(i)[order[i]] = 1;
+  }
+  return result;
+}
+
+
+/*  Row i of L has the multipliers of the pivots above it, and a 1 on the    *
+ *    diagonal.                                                              *
+ */
+Matrix LUFactorization::lower() const
+{
+  Matrix result = identityMatrix(factors.rows);
+  for (int i = 0; i < factors.rows; i++) {
+    for (int r = 0; r < i && r < rank(); r++) {
+      result.rowStart(i)[r] = factors.rowStart(i)[pivotCols[r]];
+    }
+  }
+  return result;
+}
+
+
+/*  Row i of U is what follows its pivot; rows past the last pivot are zero. *
+ */
+Matrix LUFactorization::upper() const
+{
+  Matrix result(factors.rows, factors.cols);
+  for (int i = 0; i < rank(); i++) {
+    copy(factors.rowStart(i) + pivotCols[i],
+	 factors.rowStart(i) + factors.cols,
+	 result.rowStart(i) + pivotCols[i]);
+  }
+  return result;
+}
+
+
+void LUFactorization::print(ostream &stream, const string &lineStart) const
+{
+  stream << lineStart << "P:" << endl;
+  permutation().print(stream, lineStart);
+  stream << lineStart << "L:" << endl;
+  lower().print(stream, lineStart);
+  stream << lineStart << "U:" << endl;
+  upper().print(stream, lineStart);
+}
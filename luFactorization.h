@@ -0,0 +1,75 @@
+/*---------------------------------------------------------------------------*\
+ *                              luFactorization.h                            *
+ *                   Interface for the LUFactorization class                 *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Holds a matrix A factored as PA = LU, where P reorders the rows, L is  *
+ *      lower triangular with 1s on its diagonal, and U is in echelon form.  *
+ *    The elimination is done once, when the factorization is made; after    *
+ *      that the determinant and rank are known at once, and each system     *
+ *      Ax = b is solved by substituting through L and U, in time            *
+ *      proportional to the square of the size rather than the cube.         *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -The arithmetic is exact, with Matrix's Fractions, so entries that      *
+ *      overflow are nan, as they would be in the matrix itself.             *
+ *   -Pivots are chosen as Matrix::reduce() chooses them: the entry of       *
+ *      largest magnitude in each column that has a nonzero one.             *
+ *   -A factorization can be copied and assigned like a Matrix.              *
+\*---------------------------------------------------------------------------*/
+#ifndef LUFACTORIZATION_CLASS_INCLUDED
+#define LUFACTORIZATION_CLASS_INCLUDED
+#include<iostream>
+#include<string>
+#include<vector>
+#include "fraction.h"
+#include "matrix.h"
+using namespace std;
+
+class LUFactorization
+{
+ public:
+  /*  Constructors                                                           *
+   *  Default constructor factors the empty matrix.                          *
+   *  Second constructor factors the given matrix, which may be any shape.   *
+   */
+  LUFactorization();
+  LUFactorization(const Matrix &m);
+
+  /*  Give the dimensions of the matrix that was factored.                   *
+   */
+  int getRows() const;
+  int getCols() const;
+
+  /*  Give the number of pivots, and the determinant.  The determinant of a  *
+   *    matrix that is not square is nan.                                    *
+   */
+  int rank() const;
+  Fraction determinant() const;
+
+  /*  Returns the x for which Ax = b.  Each column of b is a separate system,*
+   *    whose solution is the same column of x.  Only a square matrix of     *
+   *    full rank, and a b with as many rows, give a solution; otherwise     *
+   *    returns the empty matrix.                                            *
+   */
+  Matrix solve(const Matrix &b) const;
+
+  /*  Give the factors themselves.                                           *
+   */
+  Matrix permutation() const;
+  Matrix lower() const;
+  Matrix upper() const;
+
+  /*  Prints P, L and U in turn, each under its name, with the given string  *
+   *    starting each line.                                                  *
+   */
+  void print(ostream &stream, const string &lineStart) const;
+
+ private:
+  Matrix factors;              /* U, with L's multipliers below its pivots */
+  vector<int> order;           /* order[i] is A's row that is PA's row i   */
+  vector<int> pivotCols;       /* The column of each pivot, in order       */
+  Fraction det;
+};
+
+#endif
@@ -6,169 +6,376 @@
  * Last Modified: May 8, 2014                                                *
  *                                                                           *
  *  Note on representation:                                                  *
- *    The matrix is a dynamic 2D array.  The first dereference accesses a    *
- *    particular row; the second dereference gives the cell within that row. *
- *    Accessing an element should thus be matrix[row][col].                  *
- *    Thus, for allocating a new matrix, rows are allocated first, then      *
- *    each given an array of [columns] cells.                                *
+ *    The entries are kept in a single array, one row after another, so a    *
+ *    matrix takes one allocation however many rows it has, and a row's      *
+ *    entries are next to each other in memory.  rowStart(i) points to the   *
+ *    start of row i, so an entry is rowStart(i)[j].                         *
+ *    Switching two rows exchanges their entries, which takes time linear in *
+ *    the number of columns rather than constant time, but keeps every row   *
+ *    in place for the loops that walk along them.                           *
 \*---------------------------------------------------------------------------*/
 
+#include<algorithm>
+#include<climits>
+#include<cmath>
+#include<cstdio>
 #include<iostream>
+#include<sstream>
+#include<string>
+#include<type_traits>
+#include<vector>
+#include "bigInteger.h"
+#include "bigRational.h"
 #include "fraction.h"
+#include "fractionVector.h"
+#include "modInteger.h"
+#include "blockMultiply.h"
+#include "threadPool.h"
 #include "matrix.h"
 using namespace std;
 
+/*  The fewest columns for which row operations use batch arithmetic.        */
+static const int MIN_BATCH_COLS = 4;
 
-/*  Constructors allocate space for the matrix based on the size needed,     *
- *    and initialize all values to zero.                                     *
+/*  Doubles within this of zero are taken as zero when choosing pivots, and  *
+ *    set to zero once a reduction is done, so that what is left of a zero   *
+ *    by rounding error is neither used as a pivot nor shown.                *
  */
-Matrix::Matrix()
+static const double DOUBLE_TOLERANCE = 1e-12;
+
+
+/*  The few things that differ between the types of entry.  Each type has    *
+ *    its own overload, so the choice is made at compile time, and inlined.  *
+ *  isZero() decides which entries can be pivots, and largerPivot() which    *
+ *    of two entries makes the better one:  that of larger magnitude, for    *
+ *    numbers that have one, which keeps the multipliers small, or, modulo   *
+ *    some number, one that has an inverse, as only such an entry can be a   *
+ *    pivot at all.                                                          *
+ */
+static bool isZero(const Fraction &value)
 {
-  rows = 0;
-  cols = 0;
-  matrix = NULL;
+  return value == 0;
 }
 
+static bool isZero(double value)
+{
+  return fabs(value) <= DOUBLE_TOLERANCE;
+}
 
-Matrix::Matrix(int size)
+static bool isZero(const BigRational &value)
 {
-  Matrix(size, 1);
-  /*  rows = size;
-  cols = 1;
-  matrix = new Fraction *[size];
-  for (int i = 0; i < size; i++) {
-    matrix[i] = new Fraction[1];
-    matrix[i][0] = 0;
-    }*/
+  return value == 0;
 }
 
+static bool isZero(const ModInteger &value)
+{
+  return value == 0;
+}
 
-Matrix::Matrix(int rows, int cols)
+static bool largerPivot(const Fraction &entry, const Fraction &best)
 {
-  this->rows = rows;
-  this->cols = cols;
-  matrix = new Fraction *[rows];
-  for (int i = 0; i < rows; i++) {
-    matrix[i] = new Fraction[cols];
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] = 0;
-    }
+  Fraction size = entry.isNegative() ? -entry : entry;
+  return best.isNegative() ? (-best < size) : (best < size);
+}
+
+static bool largerPivot(double entry, double best)
+{
+  return fabs(best) < fabs(entry);
+}
+
+static bool largerPivot(const BigRational &entry, const BigRational &best)
+{
+  BigRational size = entry.isNegative() ? -entry : entry;
+  return best.isNegative() ? (-best < size) : (best < size);
+}
+
+static bool largerPivot(const ModInteger &entry, const ModInteger &best)
+{
+  if (isZero(best)) return !isZero(entry);
+  return best.reciprocal().isNan() && !entry.reciprocal().isNan();
+}
+
+static Fraction reciprocal(const Fraction &value)
+{
+  return value.reciprocal();
+}
+
+static double reciprocal(double value)
+{
+  return 1 / value;
+}
+
+static BigRational reciprocal(const BigRational &value)
+{
+  return value.reciprocal();
+}
+
+static ModInteger reciprocal(const ModInteger &value)
+{
+  return value.reciprocal();
+}
+
+static bool isNan(const Fraction &value)
+{
+  return value.isNan();
+}
+
+static bool isNan(double value)
+{
+  return std::isnan(value);
+}
+
+static bool isNan(const BigRational &value)
+{
+  return value.isNan();
+}
+
+static bool isNan(const ModInteger &value)
+{
+  return value.isNan();
+}
+
+static void setNan(Fraction *value)
+{
+  *value = Fraction(1, 0);
+}
+
+static void setNan(double *value)
+{
+  *value = NAN;
+}
+
+static void setNan(BigRational *value)
+{
+  *value = BigRational(1, 0);
+}
+
+static void setNan(ModInteger *value)
+{
+  *value = ModInteger(0, 0);
+}
+
+
+/*  Returns whether every one of the given Fractions is an integer.          *
+ */
+static bool integral(const Fraction *values, int count)
+{
+  for (int i = 0; i < count; i++) {
+    if (values[i].getDenominator() != 1) return false;
   }
+  return true;
 }
 
 
-Matrix::~Matrix()
+/*  Appends an entry to text, as print() shows it.  Fractions are formatted  *
+ *    without a stream (see Fraction::format), and doubles to 10 significant *
+ *    digits.                                                                *
+ */
+static void appendEntry(string *text, const Fraction &value)
 {
-  for (int i = 0; i < rows; i++) {
-    delete [] matrix[i];
+  char cell[Fraction::MAX_LENGTH];
+  text->append(cell, value.format(cell));
+}
+
+static void appendEntry(string *text, double value)
+{
+  char cell[32];
+  if (std::isnan(value)) {
+    text->append("nan");
+  } else {
+    text->append(cell, snprintf(cell, sizeof cell, "%.10g",
+                                (value == 0) ? 0.0 : value));
   }
-  delete [] matrix;
+}
+
+static void appendEntry(string *text, const BigRational &value)
+{
+  ostringstream stream;
+  value.print(stream);
+  text->append(stream.str());
+}
+
+static void appendEntry(string *text, const ModInteger &value)
+{
+  ostringstream stream;
+  value.print(stream);
+  text->append(stream.str());
+}
+
+template<class T>
+int BasicMatrix<T>::strassenThreshold = 64;
+
+template<>
+int BasicMatrix<double>::strassenThreshold = 0;
+
+
+/*  Constructors allocate space for the matrix based on the size needed.     *
+ *    Every type of entry starts out as zero, so they need no further        *
+ *    setting.                                                               *
+ */
+template<class T>
+BasicMatrix<T>::BasicMatrix()
+{
+  rows = 0;
+  cols = 0;
+  entries = NULL;
 }
 
 
-Matrix::Matrix(const Matrix &rval)
+template<class T>
+BasicMatrix<T>::BasicMatrix(int size)
+{
+  allocate(size, 1);
+}
+
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols)
+{
+  allocate(rows, cols);
+}
+
+
+template<class T>
+BasicMatrix<T>::~BasicMatrix()
+{
+  delete [] entries;
+}
+
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &rval)
+{
+  allocate(rval.rows, rval.cols);
+  copy(rval.entries, rval.entries + rows * cols, entries);
+}
+
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix &&rval)
 {
   rows = rval.rows;
   cols = rval.cols;
-  matrix = new Fraction *[rows];
-  for (int i = 0; i < rows; i++) {
-    matrix[i] = new Fraction[cols];
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] = rval.matrix[i][j];
-    }
-  }
+  entries = rval.entries;
+  rval.rows = 0;
+  rval.cols = 0;
+  rval.entries = NULL;
 }
 
 
-Matrix Matrix::operator=(Matrix rval)
+/*  The array is only reallocated if the number of entries changes.          */
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &rval)
 {
-  for (int i = 0; i < rows; i++) {
-    delete [] matrix[i];
+  if (this == &rval) return *this;
+  if (rows * cols != rval.rows * rval.cols) {
+    delete [] entries;
+    allocate(rval.rows, rval.cols);
   }
-  delete [] matrix;
-
   rows = rval.rows;
   cols = rval.cols;
-  matrix = new Fraction *[rows];
-  for (int i = 0; i < rows; i++) {
-    matrix[i] = new Fraction[cols];
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] = rval.matrix[i][j];
-    }
-  }
+  copy(rval.entries, rval.entries + rows * cols, entries);
   return *this;
 }
 
 
-Fraction Matrix::get(int row, int col)
+/*  Moving trades arrays with the source, which then frees the old one.      */
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix &&rval)
 {
-  if (validCoord(row, col)) return matrix[row][col];
-  return Fraction(1, 0);
+  swap(rows, rval.rows);
+  swap(cols, rval.cols);
+  swap(entries, rval.entries);
+  return *this;
+}
+
+
+template<class T>
+T BasicMatrix<T>::get(int row, int col) const
+{
+  T result;
+  if (validCoord(row, col)) return rowStart(row)[col];
+  setNan(&result);
+  return result;
 }
 
 
-void Matrix::set(int row, int col, Fraction val)
+template<class T>
+void BasicMatrix<T>::set(int row, int col, const T &val)
 {
-  if (validCoord(row, col)) matrix[row][col] = val;
+  if (validCoord(row, col)) rowStart(row)[col] = val;
 }
 
 
-int Matrix::getRows()
+template<class T>
+int BasicMatrix<T>::getRows() const
 {
   return rows;
 }
 
 
-int Matrix::getCols()
+template<class T>
+int BasicMatrix<T>::getCols() const
 {
   return cols;
 }
 
 
 /*  Arithmetic operators operate on every value in the matrix.               *
+ *  Those that update a matrix in place are split by rows across the shared  *
+ *    thread pool, as is classicProduct() below, in blocks big enough to be  *
+ *    worth handing to another thread (see ThreadPool::minBlock).  Every row *
+ *    is computed exactly as it would be serially, so results do not depend  *
+ *    on the number of threads.                                              *
  */
-Matrix Matrix::operator-()
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator-() const
 {
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] = -matrix[i][j];
-    }
+  BasicMatrix result(*this);
+  for (int i = 0; i < rows * cols; i++) {
+    result.entries[i] = -entries[i];
   }
-  return *this;
+  return result;
 }
 
 
-Matrix Matrix::operator+=(Matrix rval)
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const BasicMatrix &rval)
 {
-  if (rows != rval.rows || cols != rval.cols) return Matrix();
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] += rval.matrix[i][j];
+  if (rows != rval.rows || cols != rval.cols) return *this;
+  ThreadPool::shared().parallelFor(rows, ThreadPool::minBlock(cols),
+				   [&](int begin, int end) {
+    for (int i = begin * cols; i < end * cols; i++) {
+      entries[i] += rval.entries[i];
     }
-  }
+  });
   return *this;
 }
 
 
-Matrix Matrix::operator-=(Matrix rval)
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const BasicMatrix &rval)
 {
-  if (rows != rval.rows || cols != rval.cols) return Matrix();
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] -= rval.matrix[i][j];
+  if (rows != rval.rows || cols != rval.cols) return *this;
+  ThreadPool::shared().parallelFor(rows, ThreadPool::minBlock(cols),
+				   [&](int begin, int end) {
+    for (int i = begin * cols; i < end * cols; i++) {
+      entries[i] -= rval.entries[i];
     }
-  }
+  });
   return *this;
 }
 
 
-Matrix Matrix::operator*=(Fraction rval)
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(const T &rval)
 {
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols; j++) {
-      matrix[i][j] *= rval;
+  ThreadPool::shared().parallelFor(rows, ThreadPool::minBlock(cols),
+				   [&](int begin, int end) {
+    for (int i = begin * cols; i < end * cols; i++) {
+      entries[i] *= rval;
     }
-  }
+  });
   return *this;
 }
 
@@ -177,64 +384,236 @@ Matrix Matrix::operator*=(Fraction rval)
  *    the corresponding row on the left with the corresponding column on the *
  *    right.  To do that, one adds the product of the first entries to the   *
  *    product of the second entries, etc.                                    *
+ *  Large products use Strassen's method (see strassenProduct()), which      *
+ *    splits them in half along every dimension, as many times as it takes   *
+ *    for the smallest to reach strassenThreshold; the operands are padded   *
+ *    with zeros until each dimension divides evenly that many times, and    *
+ *    the padding is cut from the result.                                    *
+ *  Its sums of quadrants can overflow where the textbook sums do not.  Any  *
+ *    overflow leaves a nan in the product, since nan spreads through every  *
+ *    later sum and product; if there is one, the product is found again     *
+ *    the textbook way.  Otherwise every step was exact, and so the result   *
+ *    is the same.  Operands that already hold nan go the textbook way from  *
+ *    the start, as such a product would always be found again.             *
  */
-Matrix Matrix::operator*(Matrix rval)
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix &rval) const
 {
-  if (cols == rval.rows) {
-    Matrix retVal(rows, rval.cols);
-    for (int i = 0; i < rows; i++) {
-      for (int j = 0; j < rval.cols; j++) {
-	Fraction val = 0;
-	for (int k = 0; k < cols; k++) {
-	  val += matrix[i][k] * rval.matrix[k][j];
-	}
-	retVal.set(i, j, val);
-      }
-    }
-    return retVal;
+  if (cols != rval.rows) return BasicMatrix();
+  int smallest = min(rows, min(cols, rval.cols));
+  if (strassenThreshold <= 0 || smallest <= strassenThreshold ||
+      hasNan() || rval.hasNan()) {
+    return classicProduct(rval);
+  }
+  int levels = 0;
+  while (((smallest - 1) >> levels) + 1 > strassenThreshold) levels++;
+  int unit = 1 << levels;
+  int paddedRows = (rows + unit - 1) / unit * unit;
+  int paddedInner = (cols + unit - 1) / unit * unit;
+  int paddedCols = (rval.cols + unit - 1) / unit * unit;
+  BasicMatrix result;
+  if (paddedRows == rows && paddedInner == cols && paddedCols == rval.cols) {
+    result = strassenProduct(rval, levels);
   } else {
-    return Matrix();
+    BasicMatrix left(paddedRows, paddedInner);
+    BasicMatrix right(paddedInner, paddedCols);
+    left.setBlock(0, 0, *this);
+    right.setBlock(0, 0, rval);
+    result = left.strassenProduct(right, levels).block(0, 0, rows, rval.cols);
   }
+  if (result.hasNan()) return classicProduct(rval);
+  return result;
 }
 
 
-Matrix Matrix::operator*=(Matrix rval)
+/*  The textbook product.  The right matrix is transposed first, so that its *
+ *    columns, like the rows on the left, lie contiguously, and the products *
+ *    are then done in cache-sized tiles (see blockMultiply.h), each thread  *
+ *    taking a block of rows of the result.                                  *
+ */
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::classicProduct(const BasicMatrix &rval) const
 {
-  *this = *this * rval;
+  BasicMatrix retVal(rows, rval.cols);
+  BasicMatrix columns = ::transpose(rval);
+  int minBlock = ThreadPool::minBlock((long long)cols * rval.cols);
+  ThreadPool::shared().parallelFor(rows, minBlock, [&](int begin, int end) {
+    blockMultiply(rowStart(begin), columns.entries, retVal.rowStart(begin),
+		  end - begin, cols, rval.cols);
+  });
+  return retVal;
+}
+
+
+/*  Multiplies by Winograd's form of Strassen's method, recursing the given  *
+ *    number of levels; every dimension must divide evenly by 2^levels.      *
+ *    With each matrix split into quadrants,                                 *
+ *      s1 = a21 + a22   s2 = s1 - a11    s3 = a11 - a21   s4 = a12 - s2     *
+ *      t1 = b12 - b11   t2 = b22 - t1    t3 = b22 - b12   t4 = t2 - b21     *
+ *      m1 = a11 b11     m2 = a12 b21     m3 = s4 b22      m4 = a22 t4       *
+ *      m5 = s1 t1       m6 = s2 t2       m7 = s3 t3                         *
+ *      u2 = m1 + m6     u3 = u2 + m7                                        *
+ *    and the quadrants of the product are                                   *
+ *      c11 = m1 + m2    c12 = u2 + m5 + m3                                  *
+ *      c21 = u3 - m4    c22 = u3 + m5                                       *
+ *    which is 7 multiplications and 15 additions.                           *
+ */
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::strassenProduct(const BasicMatrix &rval,
+					       int levels) const
+{
+  if (levels == 0) return classicProduct(rval);
+  int m = rows / 2, k = cols / 2, n = rval.cols / 2;
+  BasicMatrix a11 = block(0, 0, m, k), a12 = block(0, k, m, k);
+  BasicMatrix a21 = block(m, 0, m, k), a22 = block(m, k, m, k);
+  BasicMatrix b11 = rval.block(0, 0, k, n), b12 = rval.block(0, n, k, n);
+  BasicMatrix b21 = rval.block(k, 0, k, n), b22 = rval.block(k, n, k, n);
+
+  BasicMatrix s1 = a21;
+  s1 += a22;
+  BasicMatrix s2 = s1;
+  s2 -= a11;
+  BasicMatrix s3 = a11;
+  s3 -= a21;
+  BasicMatrix s4 = a12;
+  s4 -= s2;
+  BasicMatrix t1 = b12;
+  t1 -= b11;
+  BasicMatrix t2 = b22;
+  t2 -= t1;
+  BasicMatrix t3 = b22;
+  t3 -= b12;
+  BasicMatrix t4 = t2;
+  t4 -= b21;
+
+  levels--;
+  BasicMatrix m1 = a11.strassenProduct(b11, levels);
+  BasicMatrix m2 = a12.strassenProduct(b21, levels);
+  BasicMatrix m3 = s4.strassenProduct(b22, levels);
+  BasicMatrix m4 = a22.strassenProduct(t4, levels);
+  BasicMatrix m5 = s1.strassenProduct(t1, levels);
+  BasicMatrix m6 = s2.strassenProduct(t2, levels);
+  BasicMatrix m7 = s3.strassenProduct(t3, levels);
+
+  BasicMatrix result(rows, rval.cols);
+  m2 += m1;
+  result.setBlock(0, 0, m2);
+  m1 += m6;                             /* u2 */
+  m7 += m1;                             /* u3 */
+  m1 += m5;
+  m1 += m3;
+  result.setBlock(0, n, m1);
+  m5 += m7;
+  result.setBlock(m, n, m5);
+  m7 -= m4;
+  result.setBlock(m, 0, m7);
+  return result;
+}
+
+
+/*  Copies out the given number of rows and columns, starting at the given   *
+ *    coordinates, as a matrix of their own.                                 *
+ */
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::block(int row, int col, int blockRows,
+				     int blockCols) const
+{
+  BasicMatrix result(blockRows, blockCols);
+  for (int i = 0; i < blockRows; i++) {
+    copy(rowStart(row + i) + col, rowStart(row + i) + col + blockCols,
+	 result.rowStart(i));
+  }
+  return result;
+}
+
+
+/*  Copies a matrix in, with its top left entry at the given coordinates.    *
+ */
+template<class T>
+void BasicMatrix<T>::setBlock(int row, int col, const BasicMatrix &values)
+{
+  for (int i = 0; i < values.rows; i++) {
+    copy(values.rowStart(i), values.rowStart(i) + values.cols,
+	 rowStart(row + i) + col);
+  }
+}
+
+
+/*  An invalid product is the empty matrix, which leaves this one as it was. */
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(const BasicMatrix &rval)
+{
+  if (cols == rval.rows) *this = *this * rval;
   return *this;
 }
 
 
 /*  Row operations are simple arithmetic / switching, checked for validity  *
  */
-void Matrix::switchRows(int r1, int r2)
+template<class T>
+void BasicMatrix<T>::switchRows(int r1, int r2)
 {
-  if (validCoord(r1, 0) && validCoord(r2, 0)) {
-    Fraction *temp = matrix[r1];
-    matrix[r1] = matrix[r2];
-    matrix[r2] = temp;
+  if (validCoord(r1, 0) && validCoord(r2, 0) && r1 != r2) {
+    swap_ranges(rowStart(r1), rowStart(r1) + cols, rowStart(r2));
   }
 }
 
 
-/* A row cannot be multiplied by zero. */
-void Matrix::multiplyRow(int row, Fraction factor)
+/*  A row cannot be multiplied by zero.                                      *
+ *  Rows of integers, multiplied by an integer, are handed whole to          *
+ *    FractionVector, whose batch arithmetic does small integers several at  *
+ *    a time.  Anything else needs a GCD per entry, which the batch          *
+ *    arithmetic would only do one entry at a time anyway, so those rows are *
+ *    done in place, without converting them; so are rows too short for the  *
+ *    conversion to pay for itself.                                          *
+ *  Other types of entry are always done in place.                           *
+ */
+template<class T>
+void BasicMatrix<T>::multiplyRow(int row, const T &factor)
 {
-  if (validCoord(row, 0) && factor != 0) {
-    for (int j = 0; j < cols; j++) {
-      matrix[row][j] *= factor;
+  if (!validCoord(row, 0) || factor == 0) return;
+  if constexpr (is_same<T, Fraction>::value) {
+    if (cols >= MIN_BATCH_COLS && factor.getDenominator() == 1 &&
+	integral(rowStart(row), cols)) {
+      FractionVector values(rowStart(row), cols);
+      values.scale(factor).store(rowStart(row));
+      return;
     }
   }
+  for (int j = 0; j < cols; j++) {
+    rowStart(row)[j] *= factor;
+  }
 }
 
 
-void Matrix::addRow(int first, Fraction factor, int second)
+template<class T>
+void BasicMatrix<T>::addRow(int first, const T &factor, int second)
 {
-  if (validCoord(first, 0) && validCoord(second, 0)) {
-    for (int j = 0; j < cols; j++) {
-      matrix[second][j] += matrix[first][j] * factor;
+  if (!validCoord(first, 0) || !validCoord(second, 0)) return;
+  if constexpr (is_same<T, Fraction>::value) {
+    if (cols >= MIN_BATCH_COLS && factor.getDenominator() == 1 &&
+	integral(rowStart(first), cols) && integral(rowStart(second), cols)) {
+      FractionVector values(rowStart(second), cols);
+      values.addScaled(FractionVector(rowStart(first), cols), factor);
+      values.store(rowStart(second));
+      return;
     }
   }
+  for (int j = 0; j < cols; j++) {
+    rowStart(second)[j] += rowStart(first)[j] * factor;
+  }
+}
+
+
+/*  Returns whether any entry is nan.                                        *
+ */
+template<class T>
+bool BasicMatrix<T>::hasNan() const
+{
+  for (int i = 0; i < rows * cols; i++) {
+    if (isNan(entries[i])) return true;
+  }
+  return false;
 }
 
 
@@ -246,14 +625,15 @@ void Matrix::addRow(int first, Fraction factor, int second)
  *  Note:  If there is no such column, returns cols, which is the highest    *
  *         index plus one.                                                   *
  */
-int Matrix::nextNonzero(int prev, int firstRow)
+template<class T>
+int BasicMatrix<T>::nextNonzero(int prev, int firstRow) const
 {
   bool found = false;
   int i, j;
   for (j = prev + 1; j < cols && !found; j++) {
     found = false;
     for (i = firstRow; i < rows; i++) {
-      if (matrix[i][j] != 0) {
+      if (!isZero(rowStart(i)[j])) {
 	found = true;
 	break;
       }
@@ -264,7 +644,8 @@ int Matrix::nextNonzero(int prev, int firstRow)
 }
 
 
-/*  Finds the entry in a given column with the highest absolute value.       *
+/*  Finds the entry in a given column that makes the best pivot: for numbers,*
+ *    that with the highest absolute value (see largerPivot()).              *
  *  Returns the index of the entry within the column; that is, its row.      *
  *  The first argument representes the column to search within.              *
  *  The second represents the row to begin searching at.  The function will  *
@@ -272,21 +653,16 @@ int Matrix::nextNonzero(int prev, int firstRow)
  *  Note: If all entries are zero, returns -1, as there is no pivot in such  *
  *        a column.
  */
-int Matrix::getPivot(int col, int lastRow)
+template<class T>
+int BasicMatrix<T>::getPivot(int col, int lastRow) const
 {
-  Fraction max = matrix[lastRow][col];
-  if (max < 0) max = -max;
   int maxIndex = lastRow;
   for (int i = lastRow + 1; i < rows; i++) {
-    if (matrix[i][col] > max) {
-      max = matrix[i][col];
-      maxIndex = i;
-    } else if (-1 * matrix[i][col] > max) {
-      max = -1 * matrix[i][col];
+    if (largerPivot(rowStart(i)[col], rowStart(maxIndex)[col])) {
       maxIndex = i;
     }
   }
-  if (max != 0) {
+  if (!isZero(rowStart(maxIndex)[col])) {
     return maxIndex;
   } else {
     return -1;
@@ -294,6 +670,189 @@ int Matrix::getPivot(int col, int lastRow)
 }
 
 
+/*  Bareiss's fraction-free elimination, used for matrices of integers.      *
+ *    Each step takes a pivot p and, for every other row, replaces each      *
+ *    entry x by (p * x - f * y) / prev, where f is the row's entry in the   *
+ *    pivot column, y is the pivot row's entry in x's column, and prev is    *
+ *    the previous step's pivot.  The division is always exact, and every    *
+ *    entry stays a minor of the original matrix, so the numbers grow no     *
+ *    larger than the determinant, rather than without bound as with         *
+ *    fractions.                                                             *
+ *  The work is first tried with long longs, with each step computed in      *
+ *    128 bits; if any entry would not fit, it starts over with BigIntegers. *
+ */
+static bool fromFraction(const Fraction &value, long long *result)
+{
+  if (value.getNumerator() > (unsigned long long)LLONG_MAX) return false;
+  *result = (long long)value.getNumerator();
+  if (value.isNegative()) *result = -*result;
+  return true;
+}
+
+static bool fromFraction(const Fraction &value, BigInteger *result)
+{
+  *result = BigInteger(value.getNumerator(), value.isNegative());
+  return true;
+}
+
+static bool isZero(long long value)
+{
+  return value == 0;
+}
+
+static bool isZero(const BigInteger &value)
+{
+  return value.isZero();
+}
+
+static bool combine(long long *x, long long pivot, long long factor,
+		    long long y, long long prev)
+{
+  __int128 value = (__int128)pivot * *x - (__int128)factor * y;
+  value /= prev;
+  if (value > LLONG_MAX || value < -LLONG_MAX) return false;
+  *x = (long long)value;
+  return true;
+}
+
+static bool combine(BigInteger *x, const BigInteger &pivot,
+		    const BigInteger &factor, const BigInteger &y,
+		    const BigInteger &prev)
+{
+  *x *= pivot;
+  *x -= factor * y;
+  *x /= prev;
+  return true;
+}
+
+static Fraction quotient(long long num, long long den)
+{
+  return Fraction(num, den);
+}
+
+static Fraction quotient(const BigInteger &num, const BigInteger &den)
+{
+  return BigRational(num, den).toFraction();
+}
+
+
+/*  Eliminates below each pivot, and above it too if full is set, moving     *
+ *    the pivot rows to the top in order.  A full elimination leaves every   *
+ *    pivot equal to the last one, so dividing each row by its first         *
+ *    nonzero entry gives the reduced echelon form.                          *
+ *  Rows in a step are independent, so they are split across the threads.    *
+ *  Pivots are taken only from the first width columns.  Each of the first   *
+ *    required columns must have one; if one does not, the elimination stops *
+ *    there, as the matrix is then known singular.                           *
+ *  Returns the number of pivots, or -1 if an entry would not fit.  negated  *
+ *    is set to whether an odd number of rows were switched.                 *
+ */
+template<class Integer>
+static int bareiss(vector<Integer> &a, int rows, int cols, int width,
+		   int required, bool full, bool *negated)
+{
+  vector<char> failed(rows, 0);
+  Integer prev = 1;
+  int rank = 0;
+  *negated = false;
+  for (int c = 0; c < width && rank < rows; c++) {
+    int p = rank;
+    while (p < rows && isZero(a[p * cols + c])) p++;
+    if (p == rows) {
+      if (c < required) return rank;
+      continue;
+    }
+    if (p != rank) {
+      swap_ranges(a.begin() + p * cols, a.begin() + (p + 1) * cols,
+		  a.begin() + rank * cols);
+      *negated = !*negated;
+    }
+    const Integer *pivotRow = &a[rank * cols];
+    const Integer &pivot = pivotRow[c];
+    int first = full ? 0 : rank + 1;
+    ThreadPool::shared().parallelFor(rows - first, ThreadPool::minBlock(cols),
+				     [&](int begin, int end) {
+      for (int i = first + begin; i < first + end; i++) {
+	if (i == rank) continue;
+	Integer *row = &a[i * cols];
+	Integer factor = row[c];
+	for (int j = (i < rank) ? 0 : c; j < cols && !failed[i]; j++) {
+	  if (!combine(&row[j], pivot, factor, pivotRow[j], prev)) {
+	    failed[i] = 1;
+	  }
+	}
+      }
+    });
+    for (int i = 0; i < rows; i++) {
+      if (failed[i]) return -1;
+    }
+    prev = pivot;
+    rank++;
+  }
+  return rank;
+}
+
+
+/*  The determinant is the last pivot, with its sign changed if rows were    *
+ *    switched an odd number of times, or zero if some column lacks a pivot. *
+ *    It is given as an Integer, since with BigIntegers it can be too large  *
+ *    for a Fraction.                                                        *
+ *  Returns false if Integer is too small.                                   *
+ */
+template<class Integer>
+static bool bareissDeterminant(const Fraction *entries, int size,
+			       Integer *result)
+{
+  if (size == 0) {
+    *result = 1;
+    return true;
+  }
+  vector<Integer> a(size * size);
+  for (int i = 0; i < size * size; i++) {
+    if (!fromFraction(entries[i], &a[i])) return false;
+  }
+  bool negated;
+  int rank = bareiss(a, size, size, size, size, false, &negated);
+  if (rank < 0) return false;
+  if (rank < size) {
+    *result = 0;
+  } else {
+    Integer &last = a[size * size - 1];
+    *result = negated ? -last : last;
+  }
+  return true;
+}
+
+
+/*  Replaces the entries with their reduced echelon form, taking pivots only *
+ *    from the first width columns; or, if one of the first required columns *
+ *    lacks a pivot, with a partly reduced form in which that column's       *
+ *    diagonal entry is zero.  Returns false, leaving the entries alone, if  *
+ *    Integer is too small.                                                  *
+ */
+template<class Integer>
+static bool bareissReduce(Fraction *entries, int rows, int cols, int width,
+			  int required)
+{
+  vector<Integer> a(rows * cols);
+  for (int i = 0; i < rows * cols; i++) {
+    if (!fromFraction(entries[i], &a[i])) return false;
+  }
+  bool negated;
+  if (bareiss(a, rows, cols, width, required, true, &negated) < 0) return false;
+  for (int i = 0; i < rows; i++) {
+    const Integer *row = a.data() + i * cols;
+    int lead = 0;
+    while (lead < cols && isZero(row[lead])) lead++;
+    for (int j = 0; j < cols; j++) {
+      entries[i * cols + j] = (j < lead) ? Fraction(0)
+	: quotient(row[j], row[lead]);
+    }
+  }
+  return true;
+}
+
+
 /*  Reduces the matrix, using row operations to turn it to reduced echelon   *
  *    form.  The algorithm is:                                               *
  *  1) Find the first nonzero row.                                           *
@@ -303,25 +862,97 @@ int Matrix::getPivot(int col, int lastRow)
  *     row addition.                                                         *
  *  5) Repeat from step one, ignoring the row that was just given a pivot.   *
  *     Stop when all rows are filled and/or there are no more nonzero rows.  *
+ *  A matrix of integer Fractions is instead reduced by Bareiss's method,    *
+ *    above, which gives the same result without ever taking a fraction      *
+ *    until the last step.                                                   *
+ *  Doubles within DOUBLE_TOLERANCE of zero are then set to zero.            *
+ */
+template<class T>
+void BasicMatrix<T>::reduce()
+{
+  reduceLeft(cols);
+}
+
+
+/*  As reduce(), but with pivots taken only from the first width columns,    *
+ *    so that the rest are carried along, as the right side of a system.     *
  */
-void Matrix::reduce()
+template<class T>
+void BasicMatrix<T>::reduceLeft(int width)
 {
+  if constexpr (is_same<T, Fraction>::value) {
+    if (integral(entries, rows * cols)) {
+      if (!bareissReduce<long long>(entries, rows, cols, width, 0)) {
+	bareissReduce<BigInteger>(entries, rows, cols, width, 0);
+      }
+      return;
+    }
+  }
   int iMax = 0;
   int current_row = 0;
-  for (int j = nextNonzero(-1, 0); j < cols; j = nextNonzero(j, current_row)) {
+  for (int j = nextNonzero(-1, 0); j < width;
+       j = nextNonzero(j, current_row)) {
     iMax = getPivot(j, current_row);
     switchRows(current_row, iMax);
-    multiplyRow(current_row, matrix[current_row][j].reciprocal());
+    multiplyRow(current_row, reciprocal(rowStart(current_row)[j]));
 
     for (int i = current_row + 1; i < rows; i++) {
-      addRow(current_row, -1 * matrix[i][j], i);
+      addRow(current_row, -rowStart(i)[j], i);
     }
     for (int i = current_row - 1; i >= 0; i--) {
-      addRow(current_row, -1 * matrix[i][j], i);
+      addRow(current_row, -rowStart(i)[j], i);
     }
     current_row++;
   }
+  if constexpr (is_floating_point<T>::value) {
+    for (int i = 0; i < rows * cols; i++) {
+      if (isZero(entries[i])) entries[i] = 0;
+    }
+  }
+}
+
+
+/*  A square matrix is transposed by exchanging entries across the diagonal; *
+ *    each row exchanges the entries right of the diagonal with those in the *
+ *    matching column, so rows can be done in parallel.  Any other matrix    *
+ *    changes shape, and is copied into a new array of the new shape, which  *
+ *    then takes the old one's place.                                        *
+ */
+template<class T>
+void BasicMatrix<T>::transpose()
+{
+  if (rows == cols) {
+    ThreadPool::shared().parallelFor(rows, ThreadPool::minBlock(cols / 2),
+				     [&](int begin, int end) {
+      for (int i = begin; i < end; i++) {
+	for (int j = i + 1; j < cols; j++) {
+	  swap(rowStart(i)[j], rowStart(j)[i]);
+	}
+      }
+    });
+  } else {
+    BasicMatrix result(cols, rows);
+    transposeInto(result);
+    *this = move(result);
+  }
+}
+
 
+/*  Fills in result, which must be cols x rows, with the transpose, a block  *
+ *    of its rows at a time.                                                 *
+ */
+template<class T>
+void BasicMatrix<T>::transposeInto(BasicMatrix &result) const
+{
+  ThreadPool::shared().parallelFor(cols, ThreadPool::minBlock(rows),
+				   [&](int begin, int end) {
+    for (int j = begin; j < end; j++) {
+      T *column = result.rowStart(j);
+      for (int i = 0; i < rows; i++) {
+	column[i] = rowStart(i)[j];
+      }
+    }
+  });
 }
 
 
@@ -336,108 +967,327 @@ void Matrix::reduce()
  *  The result of this algorithm is a triangular matrix, the determinant of  *
  *    which can be calculated by multiplying the diagonal entries.           *
  *    In this algorithm, the diagonal entries will all be either 0 or 1.     *
+ *  A matrix of integer Fractions instead uses Bareiss's method, above.      *
  */
-Fraction Matrix::determinant()
+template<class T>
+T BasicMatrix<T>::determinant() const
 {
-  if (rows != cols) return Fraction(1, 0);
-  Matrix temp = *this;
+  T result;
+  if (rows != cols) {
+    setNan(&result);
+    return result;
+  }
+  if constexpr (is_same<T, Fraction>::value) {
+    if (integral(entries, rows * cols)) {
+      long long small;
+      if (bareissDeterminant(entries, rows, &small)) return Fraction(small);
+      BigInteger big;
+      bareissDeterminant(entries, rows, &big);
+      return BigRational(big).toFraction();
+    }
+  }
+  if (rows == 0) return 1;
+  BasicMatrix temp = *this;
   int iMax = 0;
   int iterations = 0;
-  Fraction result = 1;
-  for (int j = nextNonzero(-1, 0); j < cols;
-       j = nextNonzero(j, iterations)) {
-    iMax = getPivot(j, iterations);
+  result = 1;
+  for (int j = temp.nextNonzero(-1, 0); j < cols;
+       j = temp.nextNonzero(j, iterations)) {
+    iMax = temp.getPivot(j, iterations);
     if (iterations != iMax) {
       result = -result;
-      switchRows(iterations, iMax);
+      temp.switchRows(iterations, iMax);
     }
-    result *= matrix[iterations][j];
-    multiplyRow(iterations, matrix[iterations][j].reciprocal());
+    result *= temp.rowStart(iterations)[j];
+    temp.multiplyRow(iterations, reciprocal(temp.rowStart(iterations)[j]));
 
     for (int i = iterations + 1; i < rows; i++) {
-      addRow(iterations, -1 * matrix[i][j], i);
+      temp.addRow(iterations, -temp.rowStart(i)[j], i);
     }
     iterations++;
   }
 
   /* In reduced echelon form, if the lower-right entry is not zero, no diagonal
-     entries are zero.  If it is zero, the determinant is zero. */
-  result *= matrix[rows - 1][cols - 1];
-
-  *this = temp;
+     entries are zero.  If it is zero, the determinant is zero; for doubles,
+     that includes being within DOUBLE_TOLERANCE of it. */
+  const T &last = temp.rowStart(rows - 1)[cols - 1];
+  result *= isZero(last) ? T(0) : last;
   return result;
 }
 
 
-bool Matrix::validCoord(int row, int col)
+/*  As determinant(), but a matrix of integers keeps the exact value that    *
+ *    Bareiss's method finds in BigIntegers, rather than giving nan when it  *
+ *    is too large for a Fraction.                                           *
+ */
+BigRational exactDeterminant(const Matrix &m)
 {
-  return (row < rows && col < cols && row >= 0 && col >= 0);
+  if (m.rows != m.cols || !integral(m.entries, m.rows * m.cols)) {
+    return BigRational(m.determinant());
+  }
+  long long small;
+  if (bareissDeterminant(m.entries, m.rows, &small)) return BigRational(small);
+  BigInteger big;
+  bareissDeterminant(m.entries, m.rows, &big);
+  return BigRational(big);
 }
 
 
-void Matrix::print(ostream &stream)
+/*  Eliminates on [A | I], built once in a buffer twice A's width.  If A is  *
+ *    invertible, its half reduces to the identity, and the same steps turn  *
+ *    I into A's inverse.  The first column left without a pivot shows that  *
+ *    A is singular, and the elimination stops there.                        *
+ *  Matrices of integer Fractions are eliminated by Bareiss's method, like   *
+ *    reduce().                                                              *
+ */
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::inverse() const
 {
-  print(stream, "");
+  if (rows != cols || rows == 0) return BasicMatrix();
+  BasicMatrix augmented(rows, 2 * cols);
+  for (int i = 0; i < rows; i++) {
+    copy(rowStart(i), rowStart(i) + cols, augmented.rowStart(i));
+    augmented.rowStart(i)[cols + i] = 1;
+  }
+  bool bareissDone = false;
+  if constexpr (is_same<T, Fraction>::value) {
+    if (integral(entries, rows * cols)) {
+      if (!bareissReduce<long long>(augmented.entries, rows, 2 * cols, cols,
+				    cols)) {
+	bareissReduce<BigInteger>(augmented.entries, rows, 2 * cols, cols,
+				  cols);
+      }
+      for (int i = 0; i < rows; i++) {
+	if (augmented.rowStart(i)[i] != 1) return BasicMatrix();
+      }
+      bareissDone = true;
+    }
+  }
+  if (!bareissDone && !augmented.eliminatePivots(cols)) {
+    return BasicMatrix();
+  }
+  BasicMatrix result(rows, cols);
+  for (int i = 0; i < rows; i++) {
+    copy(augmented.rowStart(i) + cols, augmented.rowStart(i) + 2 * cols,
+	 result.rowStart(i));
+  }
+  return result;
 }
 
 
-void Matrix::print(ostream &stream, string lineStart)
+/*  Gauss-Jordan elimination, requiring a pivot on the diagonal of each of   *
+ *    the first count columns, and stopping with false at the first column   *
+ *    that has none.  Pivots are chosen as by reduce().                      *
+ *  Each step works with only the nonzero entries of the pivot row.  Those   *
+ *    left of the pivot are zero by then, and a row of [A | I] starts with   *
+ *    just one nonzero entry on its right, so much of each row is skipped,   *
+ *    early on especially.  Rows that already have a zero in the pivot       *
+ *    column are skipped too.  Neither changes the result, as adding zero    *
+ *    leaves an entry exactly as it was.                                     *
+ */
+template<class T>
+bool BasicMatrix<T>::eliminatePivots(int count)
 {
-  //  stream << rows << " x " << cols << endl;
-  if (rows == 0 || cols == 0) return;
-  int lengths[cols];
-  getColLengths(lengths);
-  for (int i = 0; i < rows; i++) {
-    stream << lineStart << "|";
-    for (int j = 0; j < cols; j++) {
-      if (!matrix[i][j].isNegative()) {
-	stream << " ";
+  vector<int> nonzero;
+  for (int k = 0; k < count; k++) {
+    int pivot = getPivot(k, k);
+    if (pivot < 0) return false;
+    switchRows(k, pivot);
+    T *pivotRow = rowStart(k);
+    T scale = reciprocal(pivotRow[k]);
+    pivotRow[k] = 1;
+    nonzero.clear();
+    for (int j = k + 1; j < cols; j++) {
+      if (pivotRow[j] != 0) {
+	pivotRow[j] *= scale;
+	nonzero.push_back(j);
       }
-      matrix[i][j].print(stream);
-      int spaces = lengths[j] - matrix[i][j].length();
-      for (int k = 0; k <= spaces; k++) {
-	stream << " ";
+    }
+    int minBlock = ThreadPool::minBlock(nonzero.size());
+    ThreadPool::shared().parallelFor(rows, minBlock,
+				     [&](int begin, int end) {
+      for (int i = begin; i < end; i++) {
+	T *row = rowStart(i);
+	if (i == k || row[k] == 0) continue;
+	T factor = -row[k];
+	row[k] = 0;
+	for (size_t n = 0; n < nonzero.size(); n++) {
+	  row[nonzero[n]] += pivotRow[nonzero[n]] * factor;
+	}
       }
-      if (matrix[i][j].isNegative()) {
-	stream << " ";
+    });
+  }
+  return true;
+}
+
+
+/*  After [A | B] is reduced, using pivots from A's columns only, a row with  *
+ *    no pivot is zero in A, so its entries in B must be zero too, or that   *
+ *    column's system is inconsistent.  Otherwise each row with a pivot      *
+ *    gives the value of its pivot's variable, less the free variables      *
+ *    times the entries in their columns, so setting each free variable to   *
+ *    1 in turn, and the others to 0, gives the solutions of AX = 0.         *
+ */
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::solve(const BasicMatrix &b,
+				     BasicMatrix *nullSpace,
+				     vector<int> *unsolvable) const
+{
+  unsolvable->clear();
+  *nullSpace = BasicMatrix();
+  if (b.rows != rows || rows == 0) return BasicMatrix();
+  BasicMatrix augmented(rows, cols + b.cols);
+  for (int i = 0; i < rows; i++) {
+    copy(rowStart(i), rowStart(i) + cols, augmented.rowStart(i));
+    copy(b.rowStart(i), b.rowStart(i) + b.cols,
+	 augmented.rowStart(i) + cols);
+  }
+  augmented.reduceLeft(cols);
+
+  vector<int> pivotRow(cols, -1);
+  vector<bool> inconsistent(b.cols, false);
+  for (int i = 0; i < rows; i++) {
+    const T *row = augmented.rowStart(i);
+    int lead = 0;
+    while (lead < cols && isZero(row[lead])) lead++;
+    if (lead < cols) {
+      pivotRow[lead] = i;
+    } else {
+      for (int c = 0; c < b.cols; c++) {
+	if (!isZero(row[cols + c])) inconsistent[c] = true;
       }
     }
-    stream << "|" << endl;
   }
+  for (int c = 0; c < b.cols; c++) {
+    if (inconsistent[c]) unsolvable->push_back(c);
+  }
+  if (!unsolvable->empty()) return BasicMatrix();
+
+  BasicMatrix x(cols, b.cols);
+  *nullSpace = BasicMatrix(cols, count(pivotRow.begin(), pivotRow.end(), -1));
+  int next = 0;
+  for (int j = 0; j < cols; j++) {
+    if (pivotRow[j] >= 0) {
+      const T *row = augmented.rowStart(pivotRow[j]);
+      copy(row + cols, row + cols + b.cols, x.rowStart(j));
+      continue;
+    }
+    nullSpace->rowStart(j)[next] = 1;
+    for (int k = 0; k < j; k++) {
+      if (pivotRow[k] >= 0) {
+	nullSpace->rowStart(k)[next] = -augmented.rowStart(pivotRow[k])[j];
+      }
+    }
+    next++;
+  }
+  return x;
 }
 
 
-/*  Takes an array by reference, storing the size of the largest entry       *
- *  (in terms of characters) in the respective array locations.              *
- *  Used to line up the entries in a column, for printing.                   *
+/*  Uses repeated squaring:  the base is squared once per bit of the         *
+ *    exponent, and multiplied into the result for each bit that is set, so  *
+ *    only O(log exp) matrix multiplications are needed.                     *
  */
-void Matrix::getColLengths(int lens[])
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::power(int exp) const
 {
-  for (int j = 0; j < cols; j++) {
-    lens[j] = colLen(j);
+  if (rows != cols || rows == 0) return BasicMatrix();
+  BasicMatrix base = (exp < 0) ? inverse() : *this;
+  if (base.rows == 0) return BasicMatrix();
+  unsigned remaining = (exp < 0) ? 0U - (unsigned)exp : exp;
+  BasicMatrix result = identityMatrix<T>(rows);
+  while (remaining > 0) {
+    if (remaining & 1) result = result * base;
+    remaining >>= 1;
+    if (remaining > 0) base = base * base;
   }
+  return result;
 }
 
 
-/*  Finds the largest entry (in chars) in a column, which establishes the    *
- *  width of the column, for printing.                                       *
+/*  Sets the dimensions, and allocates an array of zeros to match; the      *
+ *    entries are value-initialized, so that doubles are zeros too.          *
+ *    Negative dimensions are taken as zero.                                 *
  */
-int Matrix::colLen(int col)
+template<class T>
+void BasicMatrix<T>::allocate(int rows, int cols)
 {
-  int max = matrix[0][col].length();
-  if (matrix[0][col].isNegative()) max--;
-  for (int i = 1; i < rows; i++) {
-    int t = matrix[i][col].length();
-    if (matrix[i][col].isNegative()) t--;
-    if (t > max) max = t;
+  this->rows = (rows > 0) ? rows : 0;
+  this->cols = (cols > 0) ? cols : 0;
+  entries = new T[this->rows * this->cols]();
+}
+
+
+template<class T>
+bool BasicMatrix<T>::validCoord(int row, int col) const
+{
+  return (row < rows && col < cols && row >= 0 && col >= 0);
+}
+
+
+template<class T>
+void BasicMatrix<T>::print(ostream &stream) const
+{
+  print(stream, "");
+}
+
+
+/*  Every entry is formatted exactly once, into one buffer, and the column   *
+ *    widths are found in that same pass.  Every row then has the same      *
+ *    layout, so each is assembled by copying its entries to fixed offsets   *
+ *    within a line of spaces, and written to the stream in a single call.   *
+ *    Rows end with '\n' rather than endl, so the stream is not flushed once *
+ *    per row.                                                               *
+ *  Within a column, entries line up with a slot for the sign before them,   *
+ *    followed by enough padding to reach the column's width.                *
+ */
+template<class T>
+void BasicMatrix<T>::print(ostream &stream, const string &lineStart) const
+{
+  if (rows == 0 || cols == 0) return;
+  vector<unsigned> widths(cols, 0);
+  vector<unsigned> ends(rows * cols);
+  string text;
+  text.reserve(rows * cols * 4);
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++) {
+      unsigned begin = text.size();
+      appendEntry(&text, rowStart(i)[j]);
+      ends[i * cols + j] = text.size();
+      unsigned width = text.size() - begin - (text[begin] == '-');
+      if (width > widths[j]) widths[j] = width;
+    }
+  }
+
+  unsigned lineLength = lineStart.size() + 3;
+  for (int j = 0; j < cols; j++) {
+    lineLength += widths[j] + 2;
+  }
+  string line(lineLength, ' ');
+  line.replace(0, lineStart.size(), lineStart);
+  line[lineStart.size()] = '|';
+  line[lineLength - 2] = '|';
+  line[lineLength - 1] = '\n';
+  unsigned start = 0;
+  for (int i = 0; i < rows; i++) {
+    unsigned offset = lineStart.size() + 1;
+    for (int j = 0; j < cols; j++) {
+      unsigned end = ends[i * cols + j];
+      unsigned position = offset + (text[start] == '-' ? 0 : 1);
+      line.replace(offset, widths[j] + 2, widths[j] + 2, ' ');
+      text.copy(&line[position], end - start, start);
+      offset += widths[j] + 2;
+      start = end;
+    }
+    stream.write(line.data(), lineLength);
   }
-  return max;
 }
 
 
-Matrix identityMatrix(int size)
+template<class T>
+BasicMatrix<T> identityMatrix(int size)
 {
-  Matrix r_val(size, size);
+  BasicMatrix<T> r_val(size, size);
   for (int i = 0; i < size; i++) {
     r_val.set(i, i, 1);
   }
@@ -445,17 +1295,30 @@ Matrix identityMatrix(int size)
 }
 
 
-Matrix transpose(Matrix m)
+template<class T>
+BasicMatrix<T> transpose(const BasicMatrix<T> &m)
 {
-  int cols = m.getRows();
-  int rows = m.getCols();
-  Matrix r_val(rows, cols);
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols; j++) {
-      r_val.set(i, j, m.get(j, i));
-    }
-  }
+  BasicMatrix<T> r_val(m.cols, m.rows);
+  m.transposeInto(r_val);
   return r_val;
 }
 
 
+/*  The types of entry that matrices are compiled for (see matrix.h).        *
+ */
+template class BasicMatrix<Fraction>;
+template class BasicMatrix<double>;
+template class BasicMatrix<BigRational>;
+template class BasicMatrix<ModInteger>;
+
+template BasicMatrix<Fraction> identityMatrix(int size);
+template BasicMatrix<double> identityMatrix(int size);
+template BasicMatrix<BigRational> identityMatrix(int size);
+template BasicMatrix<ModInteger> identityMatrix(int size);
+
+template BasicMatrix<Fraction> transpose(const BasicMatrix<Fraction> &m);
+template BasicMatrix<double> transpose(const BasicMatrix<double> &m);
+template BasicMatrix<BigRational> transpose(const BasicMatrix<BigRational> &m);
+template BasicMatrix<ModInteger> transpose(const BasicMatrix<ModInteger> &m);
+
+
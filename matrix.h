@@ -1,12 +1,12 @@
 /*---------------------------------------------------------------------------*\
  *                                 matrix.h                                  *
- *                        Interface for the Matrix class                     *
+ *                     Interface for the BasicMatrix template                *
  *                                                                           *
  *    Written by: Colin Hamilton, Tufts University                           *
  * Last Modified: May 8, 2014                                                *
  *                                                                           *
  *  Purpose:                                                                 *
- *    Represents a mathematical matrix of rational numbers.                  *
+ *    Represents a mathematical matrix, of rational numbers by default.      *
  *    Allows for the creation of a matrix of any size and the filling in of  *
  *    values at locations in the matrix.                                     *
  *    Defines arithmetic operations on matrices                              *
@@ -14,14 +14,27 @@
  *    and finding the determinant.                                           *
  *                                                                           *
  *  Notes:                                                                   *
- *    Invalid operations leave the matrix unchanged, and return the empty    *
- *    matrix.                                                                *
+ *    Invalid operations leave the matrix unchanged.  Those that produce a   *
+ *    new matrix return the empty matrix instead.                            *
+ *    BasicMatrix<T> holds entries of type T: Fraction (which is Matrix,     *
+ *    below), BigRational, double or ModInteger.  Each type is compiled into *
+ *    its own copy of the code (see the end of matrix.cpp), with its         *
+ *    arithmetic inlined into the loops, and work particular to one type,    *
+ *    such as Bareiss's elimination for Fractions, chosen at compile time.   *
+ *    Doubles round, so an entry that is within 1e-12 of zero counts as zero *
+ *    when choosing pivots; otherwise rounding error could become a pivot.   *
 \*---------------------------------------------------------------------------*/
 #ifndef MATRIX_CLASS_INCLUDED
 #define MATRIX_CLASS_INCLUDED
+#include<vector>
 #include "fraction.h"
 
-class Matrix
+class BigRational;
+template<class T> class BasicMatrix;
+template<class T> BasicMatrix<T> transpose(const BasicMatrix<T> &m);
+
+template<class T>
+class BasicMatrix
 {
  public:
   /*  Constructors create a zero matrix of the specified size.               *
@@ -30,26 +43,29 @@ class Matrix
    *    size.                                                                *
    *  Third constructor creates a matrix with the given rows and columns.    *
    */
-  Matrix();
-  Matrix(int size);
-  Matrix(int rows, int cols);
+  BasicMatrix();
+  BasicMatrix(int size);
+  BasicMatrix(int rows, int cols);
 
-  /*  Allow for assignment of matrices.                                      *
+  /*  Allow for assignment of matrices.  Moving a matrix hands over its      *
+   *    entries without copying them, and leaves the source empty.           *
    */
-  Matrix(const Matrix &rval);
-  Matrix operator=(Matrix rval);
+  BasicMatrix(const BasicMatrix &rval);
+  BasicMatrix(BasicMatrix &&rval);
+  BasicMatrix &operator=(const BasicMatrix &rval);
+  BasicMatrix &operator=(BasicMatrix &&rval);
 
   /*  Get and set the value at the given coordinates in the matrix.          *
    *  Providing invalid coordinates results in set doing nothing,            *
    *  get returning nan.                                                     *
    */
-  Fraction get(int row, int col);
-  void set(int row, int col, Fraction val);
+  T get(int row, int col) const;
+  void set(int row, int col, const T &val);
 
   /*  Give the dimensions of the matrix.                                     *
    */
-  int getRows();
-  int getCols();
+  int getRows() const;
+  int getCols() const;
 
   /*  Row operations produce a matrix that is row-equivalent.                *
    *  switchRows takes the coordinates of the two rows to exchange.          *
@@ -57,16 +73,45 @@ class Matrix
    *  addRow adds the first row, multiplied by a given factor, to the second.*
    */
   void switchRows(int r1, int r2);
-  void multiplyRow(int row, Fraction factor);
-  void addRow(int first, Fraction factor, int second);
+  void multiplyRow(int row, const T &factor);
+  void addRow(int first, const T &factor, int second);
 
   /*  Row reduces the matrix, turning it into reduced echelon form.          *
    */
   void reduce();
 
+  /*  Turns the matrix into its transpose (see transpose() below).           *
+   */
+  void transpose();
+
   /*  Returns the determinant of the matrix.
    */
-  Fraction determinant();
+  T determinant() const;
+
+  /*  Returns the inverse of the matrix, found by row reducing the matrix    *
+   *    alongside the identity.  Only square, nonsingular matrices have      *
+   *    inverses; otherwise returns the empty matrix.                        *
+   */
+  BasicMatrix inverse() const;
+
+  /*  Solves AX = B, where this matrix is A, by reducing [A | B] once for    *
+   *    all the columns of B.  Returns a solution X, with any free variables *
+   *    set to zero, and sets nullSpace to a matrix with a column for each   *
+   *    free variable, spanning the solutions of AX = 0; every solution is   *
+   *    X plus some combination of its columns.                              *
+   *  If some columns of B have no solution, returns the empty matrix, and   *
+   *    lists those columns in unsolvable.  A B with a different number of   *
+   *    rows, or an empty A, also gives the empty matrix.                    *
+   */
+  BasicMatrix solve(const BasicMatrix &b, BasicMatrix *nullSpace,
+                    vector<int> *unsolvable) const;
+
+  /*  Returns the matrix raised to the given power, which is only defined    *
+   *    for square matrices.  A power of zero is the identity, and negative  *
+   *    powers are powers of the inverse.  Invalid powers return the empty   *
+   *    matrix.                                                              *
+   */
+  BasicMatrix power(int exp) const;
 
   /*  Assignment operators implement matrix arithmetic, including:           *
    *  -Matrix addition/subtraction (matrices must have same size)            *
@@ -74,41 +119,105 @@ class Matrix
    *  -Matrix multiplication; note that order matters, and if this is an     *
    *   mxn matrix, the right matrix must be nxp; an mxp matrix is produced.  *
    */
-  Matrix operator-();
-  Matrix operator+=(Matrix rval);
-  Matrix operator-=(Matrix rval);
-  Matrix operator*=(Fraction rval);
-  Matrix operator*=(Matrix rval);
-  Matrix operator*(Matrix rval);
+  BasicMatrix operator-() const;
+  BasicMatrix &operator+=(const BasicMatrix &rval);
+  BasicMatrix &operator-=(const BasicMatrix &rval);
+  BasicMatrix &operator*=(const T &rval);
+  BasicMatrix &operator*=(const BasicMatrix &rval);
+  BasicMatrix operator*(const BasicMatrix &rval) const;
+
+  /*  Products whose dimensions all exceed this size are found by Strassen   *
+   *    and Winograd's method, which takes 7 half-size products rather than  *
+   *    8, at the cost of extra additions; 0 turns it off.  The result is    *
+   *    exactly the same either way, except for doubles, whose sums round    *
+   *    differently; so it is off for them by default.                       *
+   */
+  static int strassenThreshold;
 
   /*  Prints the matrix to a given stream.  Entries will be lined up, padded *
    *    with spaces between them, with '|'s on either side of the matrix.    *
    *  The latter takes a string to start each line, useful for indenting.    *
    */
-  void print(ostream &stream);
-  void print(ostream &stream, string lineStart);
-  ~Matrix();
+  void print(ostream &stream) const;
+  void print(ostream &stream, const string &lineStart) const;
+  ~BasicMatrix();
 
  private:
-  Fraction **matrix;
+  T *entries;                  /* rows * cols entries, row after row */
   int rows;
   int cols;
 
-  int nextNonzero(int prev, int lastRow);
-  int getPivot(int row, int lastRow);
-  void getColLengths(int lens[]);
-  int colLen(int col);
-  bool validCoord(int row, int col);
+  T *rowStart(int r);
+  const T *rowStart(int r) const;
+  void allocate(int rows, int cols);
+  void transposeInto(BasicMatrix &result) const;
+  BasicMatrix classicProduct(const BasicMatrix &rval) const;
+  BasicMatrix strassenProduct(const BasicMatrix &rval, int levels) const;
+  BasicMatrix block(int row, int col, int blockRows, int blockCols) const;
+  void setBlock(int row, int col, const BasicMatrix &values);
+
+  int nextNonzero(int prev, int lastRow) const;
+  int getPivot(int row, int lastRow) const;
+  bool eliminatePivots(int count);
+  void reduceLeft(int width);
+  bool hasNan() const;
+  bool validCoord(int row, int col) const;
+
+  template<class U>
+  friend BasicMatrix<U> transpose(const BasicMatrix<U> &m);
+  friend class LUFactorization;
+  friend class SparseMatrix;
+  friend BigRational exactDeterminant(const BasicMatrix<Fraction> &m);
 };
 
 
-/*  Creates a sizexsize identity matrix (a matrix with 1s on the diagonal).  *
+/*  Gives the start of a row within the array of entries.                    */
+template<class T>
+inline T *BasicMatrix<T>::rowStart(int r)
+{
+  return entries + r * cols;
+}
+
+template<class T>
+inline const T *BasicMatrix<T>::rowStart(int r) const
+{
+  return entries + r * cols;
+}
+
+
+/*  The matrix of Fractions, which is what most code needs.                  */
+typedef BasicMatrix<Fraction> Matrix;
+
+/*  Returns the determinant of a matrix of Fractions exactly.  determinant() *
+ *    gives nan once the value is too large for a Fraction, but that of a    *
+ *    matrix of integers is found by Bareiss's method in BigIntegers, which  *
+ *    is kept here.  Other matrices give determinant()'s value.              *
+ */
+BigRational exactDeterminant(const Matrix &m);
+
+/*  Creates a sizexsize identity matrix (a matrix with 1s on the diagonal),  *
+ *    of Fractions unless another type is given.                             *
  */
-Matrix identityMatrix(int size);
+template<class T = Fraction> BasicMatrix<T> identityMatrix(int size);
 
 /*  Returns the transpase of a given matrix (turning rows into columns and   *
  *    vice-versa).                                                           *
  */
-Matrix transpose(Matrix m);
+template<class T> BasicMatrix<T> transpose(const BasicMatrix<T> &m);
+
+/*  Returns a matrix of the same size, with each entry given by calling      *
+ *    convert on the matching entry of m, to change the type of its entries. *
+ */
+template<class U, class T, class Convert>
+BasicMatrix<U> convertMatrix(const BasicMatrix<T> &m, Convert convert)
+{
+  BasicMatrix<U> result(m.getRows(), m.getCols());
+  for (int i = 0; i < m.getRows(); i++) {
+    for (int j = 0; j < m.getCols(); j++) {
+      result.set(i, j, convert(m.get(i, j)));
+    }
+  }
+  return result;
+}
 
 #endif
@@ -8,14 +8,27 @@
  *  Calculator uses RPN notation.  Objects (numbers or matrices) are stored  *
  *    on a stack, and operators may be used on them.  Numbers may be entered *
  *    as literals.  Matrices can be created with the "m" command.            *
- *    Numbers are stored as fraction, for minimal loss of accuracy.          *
+ *    Numbers are stored as exact rationals of any size, so no accuracy is   *
+ *    lost.  Matrix entries are stored as fractions; a matrix that is mostly *
+ *    zeros stores only the rest (see SparseMatrix).  A matrix can instead   *
+ *    hold doubles, big rationals, or integers modulo some number (see       *
+ *    BasicMatrix), chosen with 'c' on the matrix screen.                    *
  *  Use the -h option (or read the description() function) for more          *
  *    detailed explanations of how to use the calculator.                    *
 \*---------------------------------------------------------------------------*/
 #include<iostream>
 #include<climits>
+#include<cmath>
+#include<string>
+#include<vector>
 #include "fraction.h"
+#include "bigRational.h"
+#include "modInteger.h"
 #include "matrix.h"
+#include "luFactorization.h"
+#include "sparseMatrix.h"
+#include "threadPool.h"
+#include "tokenizer.h"
 using namespace std;
 
 void info()
@@ -47,15 +60,29 @@ void description()
 /* Global variables determine modes in which to run the calculator. */
 bool PROMPT = true;
 bool DECIMAL = false;
+int ROOT_DIGITS = 15;      /* Square roots are accurate to this many digits */
+int DECIMAL_DIGITS = 9;    /* Decimals are shown to at most this many places */
+BigRational LITERAL_LIMIT = 0;  /* Literals are approximated to this; 0 = exact */
 
-/* Different types of objects allowed on stack */
-enum nodetype {NUMBER, MATRIX};
+/* All input is read through this, a line at a time. */
+Tokenizer INPUT(cin);
+
+/* Different types of objects allowed on stack.  A matrix of fractions is a
+   MATRIX or SPARSE; one of doubles is REAL, of BigRationals EXACT, and of
+   integers modulo the node's modulus MODULAR. */
+enum nodetype {NUMBER, MATRIX, FACTORED, SPARSE, REAL, EXACT, MODULAR};
 
 /* List structure is used for the stack. */
 typedef struct Node {
   nodetype type;
   Matrix mdata;
-  Fraction fdata;
+  SparseMatrix sdata;
+  BasicMatrix<double> rdata;
+  BasicMatrix<BigRational> edata;
+  BasicMatrix<ModInteger> zdata;
+  long long modulus = 0;
+  BigRational fdata;
+  LUFactorization ldata;
   Node *rest;
 } *List;
 
@@ -70,15 +97,16 @@ void matrixOperate(List *stack);
 void help(string state);
 void instructions();
 void options();
-Fraction readFraction();
-void readDecimal(List *stack, bool add);
+bool readFraction(Fraction *value);
+void readNumber(List *stack);
+bool validLimit(const BigRational &limit);
+BigRational approximation(const BigRational &value, const BigRational &limit);
 
 /*  Different types of operations.  Deal with the stack and error-checking;  *
  *  the functions passed should leave their answer on the stack.             *
  */
 void binary(StackOp operation, List *stack);
 void unary(StackOp operation, List *stack);
-void matrixOp(Matrix (*operation)(Matrix), List stack);
 
 /*  Binary arithmetic functions.                                             *
  */
@@ -95,14 +123,50 @@ bool factorial(List stack);
 bool root(List stack);
 bool inverse(List stack);
 bool transpose(List stack);
+bool approximate(List stack);
 void determinant(List *stack);
+void solve(List *stack);
 
 /*  Marix operations.                                                        *
  */
-Matrix swap(Matrix m);
-Matrix multRow(Matrix m);
-Matrix addRow(Matrix m);
-Matrix reduce(Matrix m);
+void matrixOp(void (*operation)(List), List stack);
+void swapRows(List stack);
+void multRow(List stack);
+void addRow(List stack);
+void reduce(List stack);
+void factor(List stack);
+void changeEntries(List stack);
+
+/*  How matrices are stored on the stack.                                    *
+ */
+bool isMatrix(List stack);
+bool isFractions(List stack);
+int matrixRows(List stack);
+int matrixCols(List stack);
+void makeDense(List stack);
+void settle(List stack);
+bool sameEntries(List left, List right);
+void convert(List stack, nodetype type, long long modulus);
+void scale(List stack, const BigRational &factor);
+void product(List left, List right);
+template<class Operation> void withMatrix(List stack, Operation operation);
+template<class Operation> void withMatrices(List left, List right,
+					   Operation operation);
+
+/*  Conversions between the numbers on the stack and matrix entries.         *
+ */
+BigRational toNumber(const Fraction &entry);
+BigRational toNumber(double entry);
+BigRational toNumber(const BigRational &entry);
+BigRational toNumber(const ModInteger &entry);
+void fromNumber(const BigRational &value, Fraction *entry, long long modulus);
+void fromNumber(const BigRational &value, double *entry, long long modulus);
+void fromNumber(const BigRational &value, BigRational *entry,
+		long long modulus);
+void fromNumber(const BigRational &value, ModInteger *entry,
+		long long modulus);
+template<class T> T entryFor(const BasicMatrix<T> &m, const BigRational &value,
+			     long long modulus);
 
 /*  Create a matrix.                                                         *
  */
@@ -120,6 +184,8 @@ void duplicate(List *stack);
 
 /*  Errors and prompts.                                                      *
  */
+bool isNan(List stack);
+bool isFactored(List stack);
 void tooFew();
 void error(string message);
 void prompt(string message);
@@ -129,7 +195,7 @@ void prompt(string message);
 int main(int argc, char *argv[])
 {
   List stack = NULL;
-  cout.precision(9);
+  ios::sync_with_stdio(false);
   for (int i = 1; i < argc; i++) {
     switch (argv[i][0]) {
     case 'h': help("begin");             break;
@@ -159,7 +225,7 @@ void help(string state)
     cout << "Enter 'i' for information on the program." << endl;
     cout << "Enter 'r' to " << state << " the program." << endl;
     cout << "Enter 'q' to quit the program." << endl;
-    cin >> command;
+    if (!INPUT.read(&command)) command = 'q';
     switch (command) {
     case 'c': instructions();     break;
     case 'h': description();      break;
@@ -168,7 +234,7 @@ void help(string state)
     }
   } while (command != 'r' && command != 'q');
   if (command == 'q') {
-    cin.putback(command);
+    INPUT.putback();
   }
 }
 
@@ -179,40 +245,28 @@ void runCalc(List *stack)
   cout << "For help using this calculator, enter 'h' " << endl;
   do {
     processCommand(stack, command);
-    cin.get(command);
-  } while (command != 'q');
+  } while (INPUT.get(command) && command != 'q');
 }
 
 
 /*  Two possibilities for a command:                                         *
- *  1) It is a digit, in which case the number should be read and added to   *
- *     the stack.                                                            *
+ *  1) It is a digit or a decimal point, in which case the number should be  *
+ *     read and added to the stack.                                          *
  *  2) It is alphabetic, in which case the appropriate function should be    *
  *     called.                                                               *
  *  For explanations of which commands do what, see instructions()           *
  */
 void processCommand(List *stack, char command)
 {
-  if (isdigit(command)) {
-    cin.putback(command);
-    List temp = new Node;
-    long long input;
-    cin >> input;
-    temp->type = NUMBER;
-    temp->fdata = input;
-    temp->rest = *stack;
-    *stack = temp;
-    if (cin.peek() == '.') {  /* cin left off at first non-digit */
-      cin.get(command);
-      readDecimal(stack, true);
-    }
+  if (isdigit(command) || command == '.') {
+    INPUT.putback();
+    readNumber(stack);
     return;
   }
 
   switch (command) {
   case '\0':                                               break;
   case '\n': printStack(*stack);                           break;
-  case '.': readDecimal(stack, false);                     break;
   case '+': binary(add, stack);                            break;
   case '-': binary(subtract, stack);                       break;
   case '*': binary(multiply, stack);                       break;
@@ -220,10 +274,12 @@ void processCommand(List *stack, char command)
   case '^': binary(power, stack);                          break;
   case '!': unary(factorial, stack);                       break;
   case '|': determinant(stack);                            break;
+  case '\\': solve(stack);                                 break;
   case 'c': unary(changeSign, stack);                      break;
   case 'd': duplicate(stack);                              break;
   case 'h': help("return to");                             break;
   case 'i': unary(inverse, stack);                         break;
+  case 'l': binary(approximate, stack);                    break;
   case 'm': matrixOperate(stack);                          break;
   case 'o': options();                                     break;
   case 'p': pop(stack);                                    break;
@@ -250,9 +306,18 @@ void instructions()
   cout << "'/': Divide the second entry on the stack by the top entry."<< endl;
   cout << "'^': Raises the second entry to the power of the top entry."<< endl;
   cout << "'!': Takes the factorial of the top number on the stack." << endl;
+  cout << "'\\': Solves AX = B, for matrices A and then B on the" << endl
+       << "     stack.  If variables are free, a matrix N goes on top" << endl
+       << "     of X, and every solution is X + Nt." << endl;
   cout << "'c': Changes the sign of the top entry on the stack." << endl;
   cout << "'d': Duplicates the top entry on the stack." << endl;
   cout << "'h': Opens the help screen." << endl;
+  cout << "'i': Takes the reciprocal of the top entry, or the inverse" << endl
+       << "     of a matrix." << endl;
+  cout << "'l': Approximates the second entry by a simpler fraction. If" << endl
+       << "     the top entry is a whole number, it is the largest" << endl
+       << "     denominator allowed; if it is between 0 and 1, it is" << endl
+       << "     the most the answer may differ by." << endl;
   cout << "'o': Opens the options screen." << endl;
   cout << "'p': Pops the top entry off of the stack." << endl;
   cout << "'r': Take the sqare root of the top entry." << endl;
@@ -264,6 +329,11 @@ void instructions()
   cout << "From the matrix operation screen, the following commands are "
           "allowed" << endl;
   cout << "'a': Add a multiple of one row to another." << endl;
+  cout << "'c': Change how the entries are stored: as fractions," << endl
+       << "     doubles, exact big rationals, or integers mod n." << endl;
+  cout << "'f': Factor a matrix as PA = LU.  Dividing a matrix B by" << endl
+       << "     the factorization solves AX = B, and '|' gives the" << endl
+       << "     determinant, without redoing the elimination." << endl;
   cout << "'i': Create an identity matrix of a particular size." << endl;
   cout << "'m': Multiply a row by a certain factor." << endl;
   cout << "'n': Create a new matrix, to push onto the stack." << endl;
@@ -281,36 +351,42 @@ void matrixOperate(List *stack)
 {
   char command;
   do {
-    cin.get(command);
+    if (!INPUT.get(command)) command = 'q';
       switch (command) {
       case '\n':
-	if (*stack != NULL && (*stack)->type == MATRIX) {
+	if (*stack != NULL && isMatrix(*stack)) {
 	  prompt("Operating on matrix:  ");
-	  (*stack)->mdata.print(cout, "   ");
+	  if ((*stack)->type == SPARSE) {
+	    (*stack)->sdata.print(cout, "   ");
+	  } else {
+	    withMatrix(*stack, [](auto &m) { m.print(cout, "   "); });
+	  }
 	} else {
 	  prompt("No matrix on top of stack.  Create a new one with 'm' or"
 		 " 'i'\n");
 	}                                                      break;
       case 'a': matrixOp(addRow, *stack);                      break;
-      case 'e': matrixOp(reduce, *stack);                      break;
+      case 'c': changeEntries(*stack);                         break;
+      case 'e': reduce(*stack);                                break;
+      case 'f': factor(*stack);                                break;
       case 'i': identity(stack);                               break;
       case 'm': matrixOp(multRow, *stack);                     break;
       case 'n': newMatrix(stack);                              break;
-      case 's': matrixOp(swap, *stack);                        break;
+      case 's': matrixOp(swapRows, *stack);                    break;
       case 'r': case 'q':  break;
       default:
 	cout << "Unknown command: " << command << endl;
       }
   } while (command != 'r' && command != 'q');
   if (command == 'q') {
-    cin.putback(command);
+    INPUT.putback();
   }
 }
 
 
 /*  Creates a new matrix based on the user's input.  User supplies size of   *
  *  the matrix, and values of each entry.                                    *
- *  cin.fail() cases are in case the user types, eg, "q" to quit.            *
+ *  Failed reads are in case the user types, eg, "q" to quit.               *
  *  (but also just as a general safety check)                                *
  */
 void newMatrix(List *stack)
@@ -320,12 +396,10 @@ void newMatrix(List *stack)
   int row, col;
   row = col = 0;
   prompt("Rows?  ");
-  cin >> row;
+  bool valid = INPUT.read(&row);
   prompt("Cols?  ");
-  cin >> col;
-  if (cin.fail()) {
+  if (!valid || !INPUT.read(&col)) {
     delete temp;
-    cin.clear();
     cout << endl;
     return;
   }
@@ -334,14 +408,15 @@ void newMatrix(List *stack)
   for (int i = 0; i < row; i++) {
     cout << "Row " << i+1 << "  ";
     for (int j = 0; j < col; j++) {
-      temp->mdata.set(i, j, readFraction());
-      if (cin.fail()) {
+      Fraction entry;
+      if (!readFraction(&entry)) {
 	delete temp;
-	cin.clear();
 	return;
       }
+      temp->mdata.set(i, j, entry);
     }
   }
+  settle(temp);
   temp->rest = (*stack);
   (*stack) = temp;
 }
@@ -353,8 +428,12 @@ void identity(List *stack)
   List temp = new Node;
   temp->type = MATRIX;
   prompt("What size identity matrix?  ");
-  cin >> size;
+  if (!INPUT.read(&size)) {
+    delete temp;
+    return;
+  }
   temp->mdata = identityMatrix(size);
+  settle(temp);
   temp->rest = *stack;
   *stack = temp;
 }
@@ -364,6 +443,8 @@ void identity(List *stack)
  *  answer.  The workaround used here is indistinguishable from that.        *
  *  Binary operations leave their answer as the *second* thing on the stack. *
  *  This allows binaryOp() to remove the top object.                         *
+ *  Only the four arithmetic operations work on sparse matrices; for the     *
+ *  rest, the operands are made dense first.                                 *
  */
 void binary(StackOp operation, List *stack)
 {
@@ -371,20 +452,63 @@ void binary(StackOp operation, List *stack)
     tooFew();
     return;
   }
-  if(!operation(*stack)) return;
+  if ((isFactored(*stack) || isFactored((*stack)->rest)) &&
+      operation != divide) {
+    error("A factorization can only divide a matrix, to solve systems.");
+    return;
+  }
+  bool wasNan = isNan(*stack) || isNan((*stack)->rest);
+  if (operation != add && operation != subtract && operation != multiply &&
+      operation != divide) {
+    makeDense(*stack);
+    makeDense((*stack)->rest);
+  }
+  if(!operation(*stack)) {
+    settle(*stack);
+    settle((*stack)->rest);
+    return;
+  }
   List temp = (*stack)->rest;
   delete *stack;
   *stack = temp;
+  settle(*stack);
+  if (!wasNan && isNan(*stack)) {
+    error("Overflow: the result is too large to represent.");
+  }
+}
+
+
+/*  Whether the given stack entry is a number that is nan.  Arithmetic on    *
+ *  ordinary numbers only produces nan when the result overflows.            *
+ */
+bool isNan(List stack)
+{
+  return stack->type == NUMBER && stack->fdata.isNan();
+}
+
+
+bool isFactored(List stack)
+{
+  return stack->type == FACTORED;
 }
 
 
 bool add(List stack)
 {
   List temp = stack->rest;
-  if (stack->type == MATRIX && temp->type == MATRIX) {
-    if (stack->mdata.getRows() == temp->mdata.getRows() &&
-	stack->mdata.getCols() == temp->mdata.getCols()) {
-      temp->mdata += stack->mdata;
+  if (isMatrix(stack) && isMatrix(temp)) {
+    if (matrixRows(stack) == matrixRows(temp) &&
+	matrixCols(stack) == matrixCols(temp)) {
+      if (!sameEntries(temp, stack)) return false;
+      if (stack->type == SPARSE && temp->type == SPARSE) {
+	temp->sdata += stack->sdata;
+      } else {
+	makeDense(stack);
+	makeDense(temp);
+	withMatrices(temp, stack, [](auto &left, auto &right) {
+	  left += right;
+	});
+      }
     } else {
       error("Matrices have incompatible sizes.");
       return false;
@@ -402,10 +526,19 @@ bool add(List stack)
 bool subtract(List stack)
 {
   List temp = stack->rest;
-  if (stack->type == MATRIX && temp->type == MATRIX) {
-    if (stack->mdata.getRows() == temp->mdata.getRows() &&
-	stack->mdata.getCols() == temp->mdata.getCols()) {
-      temp->mdata -= stack->mdata;
+  if (isMatrix(stack) && isMatrix(temp)) {
+    if (matrixRows(stack) == matrixRows(temp) &&
+	matrixCols(stack) == matrixCols(temp)) {
+      if (!sameEntries(temp, stack)) return false;
+      if (stack->type == SPARSE && temp->type == SPARSE) {
+	temp->sdata -= stack->sdata;
+      } else {
+	makeDense(stack);
+	makeDense(temp);
+	withMatrices(temp, stack, [](auto &left, auto &right) {
+	  left -= right;
+	});
+      }
     } else {
       error("Matrices have incompatible sizes.");
       return false;
@@ -423,23 +556,24 @@ bool subtract(List stack)
 bool multiply(List stack)
 {
   List temp = stack->rest;
-  if (stack->type == MATRIX) {
+  if (isMatrix(stack)) {
     if (temp->type == NUMBER) {
-      stack->mdata *= temp->fdata;
+      scale(stack, temp->fdata);
       stack->rest = temp->rest;
-      *temp = *stack;
+      *temp = move(*stack);
       stack->rest = temp;
     } else {
-      if (temp->mdata.getCols() == stack->mdata.getRows()) {
-	  temp->mdata *= stack->mdata;
+      if (matrixCols(temp) == matrixRows(stack)) {
+	  if (!sameEntries(temp, stack)) return false;
+	  product(temp, stack);
 	} else {
 	  error("Incompatible matrix sizes.");
 	  return false;
 	}
     }
   } else if (stack->type == NUMBER) {
-    if (temp->type == MATRIX) {
-      temp->mdata *= stack->fdata;
+    if (isMatrix(temp)) {
+      scale(temp, stack->fdata);
     } else if (temp->type == NUMBER) {
       temp->fdata *= stack->fdata;
     }
@@ -448,38 +582,84 @@ bool multiply(List stack)
 }
 
 
+/*  Powers are found by repeated squaring (see Fraction::power and          *
+ *  Matrix::power), so even large exponents need few multiplications.       *
+ */
 bool power(List stack)
 {
-  if (stack->type == MATRIX || stack->fdata.getDenominator() != 1) {
+  if (isMatrix(stack) || !stack->fdata.isInteger()) {
     error("Exponents must be integers.");
     return false;
   }
-  Fraction exp = stack->fdata;
-  if (stack->rest->type == NUMBER) {
-    List temp = stack->rest;
-    Fraction base = temp->fdata;
-    Fraction result = 1;
-    while (exp > 0) {
-      result *= base;
-      exp -= 1;
+  const BigInteger &expNumerator = stack->fdata.getNumerator();
+  if (!expNumerator.isSmall() || expNumerator.getSmall() > INT_MAX) {
+    error("Exponent is too large.");
+    return false;
+  }
+  int exp = expNumerator.getSmall();
+  if (expNumerator.isNegative()) exp = -exp;
+  List temp = stack->rest;
+  if (temp->type == NUMBER) {
+    if (exp < 0 && temp->fdata == 0) {
+      error("Zero has no negative powers.");
+      return false;
     }
-    temp->fdata = result;
+    temp->fdata = temp->fdata.power(exp);
   } else {
-    return false;
+    if (matrixRows(temp) != matrixCols(temp)) {
+      error("Powers are only defined for square matrices.");
+      return false;
+    }
+    bool singular = false;
+    withMatrix(temp, [&](auto &m) {
+      auto result = m.power(exp);
+      if (result.getRows() == 0) singular = true;
+      else m = move(result);
+    });
+    if (singular) {
+      error("Matrix is singular, so it has no negative powers.");
+      return false;
+    }
   }
   return true;
 }
 
 
+/*  Dividing a matrix B by the factorization of A solves AX = B; see         *
+ *  LUFactorization::solve.                                                  *
+ */
 bool divide(List stack)
 {
   List temp = stack->rest;
-  if (stack->type == MATRIX) {
+  if (stack->type == FACTORED) {
+    const LUFactorization &factors = stack->ldata;
+    if (!isMatrix(temp) || matrixRows(temp) != factors.getRows()) {
+      error("Need a matrix with as many rows as the factored one.");
+      return false;
+    }
+    if (!isFractions(temp)) {
+      error("A factorization can only solve for a matrix of fractions.");
+      return false;
+    }
+    if (factors.getRows() != factors.getCols() ||
+	factors.rank() < factors.getRows()) {
+      error("Only an invertible matrix has one solution for each system.");
+      return false;
+    }
+    makeDense(temp);
+    temp->mdata = factors.solve(temp->mdata);
+    return true;
+  }
+  if (temp->type == FACTORED) {
+    error("A factorization can only be used to divide by.");
+    return false;
+  }
+  if (isMatrix(stack)) {
     error("Division by a matrix is undefined.");
     return false;
   }
-  if (temp->type == MATRIX) {
-    temp->mdata *= stack->fdata.reciprocal();
+  if (isMatrix(temp)) {
+    scale(temp, stack->fdata.reciprocal());
   } else if (temp->type == NUMBER) {
     if (stack->fdata == 0) {
       error("Division by zero is undefined.");
@@ -493,6 +673,8 @@ bool divide(List stack)
 
 /*  Unary Operations leave their answer as the top thing on the stack.       *
  *  In so doing, they destroy the former object on top of the stack.         *
+ *  Sparse matrices are made dense to be inverted, since inverses are        *
+ *  rarely sparse; other operations keep them as they are.                   *
  */
 void unary(StackOp operation, List *stack)
 {
@@ -500,14 +682,22 @@ void unary(StackOp operation, List *stack)
     tooFew();
     return;
   }
+  if (isFactored(*stack)) {
+    error("That operation is not defined for a factorization.");
+    return;
+  }
+  if (operation == inverse) makeDense(*stack);
   operation(*stack);
+  settle(*stack);
 }
 
 
 bool changeSign(List stack)
 {
-  if (stack->type == MATRIX) {
-    stack->mdata = -(stack->mdata);
+  if (stack->type == SPARSE) {
+    stack->sdata = -(stack->sdata);
+  } else if (isMatrix(stack)) {
+    withMatrix(stack, [](auto &m) { m = -m; });
   } else if (stack->type == NUMBER) {
     stack->fdata = -(stack->fdata);
   }
@@ -518,40 +708,55 @@ bool changeSign(List stack)
 bool factorial(List stack)
 {
   if (stack->type != NUMBER || stack->fdata.isNegative() ||
-      stack->fdata.getDenominator() != 1) {
+      !stack->fdata.isInteger()) {
     error("Factorial is only defined for nonnegative integers.");
     return false;
   }
-  unsigned long long result = 1;
-  unsigned  base = stack->fdata.getNumerator();
-  for (unsigned i = 2; i <= base; i++) {
-    result *= i;
+  const BigInteger &base = stack->fdata.getNumerator();
+  if (!base.isSmall() || base.getSmall() > UINT_MAX) {
+    error("That factorial is too large to compute.");
+    return false;
   }
-  stack->fdata = result;
+  stack->fdata = factorial((unsigned)base.getSmall());
   return true;
 }
 
 
 bool root(List stack)
 {
-  if (stack->type == MATRIX) {
-    stack->mdata.reduce();
+  if (isMatrix(stack)) {
+    reduce(stack);
     return true;
   }
   if (stack->fdata.isNegative()) {
     error("Square roots of negative numbers are imaginary.");
     return false;
   }
-  stack->fdata = stack->fdata.sqroot();
+  stack->fdata = stack->fdata.sqroot(BigInteger(10).power(ROOT_DIGITS));
   return true;
 }
 
 
+/*  The reciprocal of a number, or the inverse of a matrix (see              *
+ *  Matrix::inverse).                                                        *
+ */
 bool inverse(List stack)
 {
-  if (stack->type == MATRIX) {
-    error("No inverse for matrices has yet been implemented.");
-    return false;
+  if (isMatrix(stack)) {
+    if (matrixRows(stack) != matrixCols(stack)) {
+      error("Inverses are only defined for square matrices.");
+      return false;
+    }
+    bool singular = false;
+    withMatrix(stack, [&](auto &m) {
+      auto result = m.inverse();
+      if (result.getRows() == 0) singular = true;
+      else m = move(result);
+    });
+    if (singular) {
+      error("Matrix is singular, so it has no inverse.");
+      return false;
+    }
   } else {
     stack->fdata = stack->fdata.reciprocal();
   }
@@ -561,21 +766,54 @@ bool inverse(List stack)
 
 bool transpose(List stack)
 {
-  if (stack->type != MATRIX) {
+  if (!isMatrix(stack)) {
     error("Transpose is only defined for matrices.");
     return false;
+  } else if (stack->type == SPARSE) {
+    stack->sdata.transpose();
+    return true;
   } else {
-    stack->mdata = transpose(stack->mdata);
+    withMatrix(stack, [](auto &m) { m.transpose(); });
     return true;
   }
 }
 
 
+/*  Approximates the second entry, or each entry of it if it is a matrix,   *
+ *  as limited by the top entry (see approximation()).                       *
+ */
+bool approximate(List stack)
+{
+  List temp = stack->rest;
+  if (stack->type != NUMBER || !validLimit(stack->fdata)) {
+    error("The limit must be a whole number, or between 0 and 1.");
+    return false;
+  }
+  if (temp->type == NUMBER) {
+    temp->fdata = approximation(temp->fdata, stack->fdata);
+  } else {
+    const BigRational &limit = stack->fdata;
+    long long modulus = temp->modulus;
+    withMatrix(temp, [&](auto &m) {
+      for (int i = 0; i < m.getRows(); i++) {
+	for (int j = 0; j < m.getCols(); j++) {
+	  BigRational entry = approximation(toNumber(m.get(i, j)), limit);
+	  m.set(i, j, entryFor(m, entry, modulus));
+	}
+      }
+    });
+  }
+  return true;
+}
+
+
 /*  Operation for "|" operator.  This is "absolute value" for a number,      *
- *  and "determinant" for a matrix.                                          *
+ *  and "determinant" for a matrix, or for a factored one, which already     *
+ *  knows it.                                                                *
  *  The former changes the top value on the stack (if it is negative).       *
  *  The latter does not change or delete the matrix.  It simply pushes the   *
- *  number found on top of the matrix.                                       *
+ *  number found on top of the matrix.  A matrix of fractions gives its      *
+ *  exact determinant (see exactDeterminant), even one too large for them.   *
  *  These divergent operations make this function unique.                    *
  */
 void determinant(List *stack)
@@ -584,13 +822,32 @@ void determinant(List *stack)
     tooFew();
     return;
   }
-  if ((*stack)->type == NUMBER && (*stack)->fdata.isNegative()) {
-    (*stack)->fdata = -((*stack)->fdata);
+  if ((*stack)->type == NUMBER) {
+    if ((*stack)->fdata.isNegative()) (*stack)->fdata = -((*stack)->fdata);
   } else {
-    if ((*stack)->mdata.getRows() != (*stack)->mdata.getCols()) {
+    bool factored = isFactored(*stack);
+    int rows = factored ? (*stack)->ldata.getRows() : matrixRows(*stack);
+    int cols = factored ? (*stack)->ldata.getCols() : matrixCols(*stack);
+    if (rows != cols) {
       error("Determinants can only be found for square matrices.");
     } else {
-      Fraction result = (*stack)->mdata.determinant();
+      BigRational result;
+      if (factored) {
+	result = (*stack)->ldata.determinant();
+      } else if ((*stack)->type == SPARSE) {
+	Fraction value = (*stack)->sdata.determinant();
+	if (value.isNan()) {
+	  result = exactDeterminant((*stack)->sdata.toMatrix());
+	} else {
+	  result = value;
+	}
+      } else if ((*stack)->type == MATRIX) {
+	result = exactDeterminant((*stack)->mdata);
+      } else {
+	withMatrix(*stack, [&](auto &m) {
+	  result = toNumber(m.determinant());
+	});
+      }
       List temp = new Node;
       temp->type = NUMBER;
       temp->fdata = result;
@@ -601,119 +858,528 @@ void determinant(List *stack)
 }
 
 
-/*  Matrix operations return a modified matrix.                              *
+/*  Operation for "\\".  Solves AX = B, with B on top of the stack and A     *
+ *  below it (see Matrix::solve), and replaces them with the solution X.     *
+ *  If some variables are free, a matrix N, whose columns span the           *
+ *  solutions of AX = 0, is left on top of X: every solution is X + Nt, for  *
+ *  any vector t.  If some system has no solution, the stack is unchanged.   *
+ */
+void solve(List *stack)
+{
+  if (*stack == NULL || (*stack)->rest == NULL) {
+    tooFew();
+    return;
+  }
+  List top = *stack, below = top->rest;
+  if (!isMatrix(top) || !isMatrix(below)) {
+    error("Solving needs two matrices, A and then B.");
+    return;
+  }
+  if (matrixRows(top) != matrixRows(below) || matrixRows(below) == 0) {
+    error("Incompatible matrix sizes.");
+    return;
+  }
+  if (!sameEntries(below, top)) return;
+  makeDense(top);
+  makeDense(below);
+  vector<int> unsolvable;
+  withMatrices(below, top, [&](auto &a, auto &b) {
+    remove_reference_t<decltype(a)> nullSpace;
+    auto x = a.solve(b, &nullSpace, &unsolvable);
+    if (!unsolvable.empty()) return;
+    a = move(x);
+    b = move(nullSpace);
+  });
+  if (!unsolvable.empty()) {
+    string columns;
+    for (size_t i = 0; i < unsolvable.size(); i++) {
+      if (i > 0) columns += ", ";
+      columns += to_string(unsolvable[i] + 1);
+    }
+    error("No solution: the system is inconsistent in column(s) " + columns
+	  + " of B.");
+    settle(top);
+    settle(below);
+    return;
+  }
+  settle(below);
+  if (matrixCols(top) == 0) {
+    pop(stack);
+  } else {
+    settle(top);
+    prompt(to_string(matrixCols(top)) + " free variable(s): every "
+	   "solution is X + Nt, with N on top of X.\n");
+  }
+}
+
+
+/*  Matrix operations modify the matrix on top of the stack in place.        *
+ *  Row operations are only defined for dense matrices.                      *
  */
-void matrixOp(Matrix (*operation)(Matrix), List stack)
+void matrixOp(void (*operation)(List), List stack)
 {
-  if (stack == NULL || stack->type != MATRIX) {
+  if (stack == NULL || !isMatrix(stack)) {
     error("Need a matrix on the stack for that operation.");
     return;
   }
-  stack->mdata = operation(stack->mdata);
+  makeDense(stack);
+  operation(stack);
+  settle(stack);
 }
 
 
-Matrix swap(Matrix m)
+void swapRows(List stack)
 {
   int r1, r2;
   prompt("Which rows do you want to swap?  ");
-  cin >> r1 >> r2;
-  m.switchRows(r1 - 1, r2 - 1);
-  return m;
+  if (INPUT.read(&r1) && INPUT.read(&r2)) {
+    withMatrix(stack, [&](auto &m) { m.switchRows(r1 - 1, r2 - 1); });
+  }
 }
 
 
-Matrix multRow(Matrix m)
+void multRow(List stack)
 {
   int row;
+  BigRational factor;
   prompt("Multiply which row?  ");
-  cin >> row;
+  if (!INPUT.read(&row)) return;
   prompt("By what factor?  ");
-  m.multiplyRow(row - 1, readFraction());
-  return m;
+  if (!INPUT.read(&factor)) return;
+  factor = approximation(factor, LITERAL_LIMIT);
+  long long modulus = stack->modulus;
+  withMatrix(stack, [&](auto &m) {
+    m.multiplyRow(row - 1, entryFor(m, factor, modulus));
+  });
 }
 
 
-Matrix addRow(Matrix m)
+void addRow(List stack)
 {
   int r1, r2;
+  BigRational factor;
   prompt("Add a multiple of which row?  ");
-  cin >> r1;
+  if (!INPUT.read(&r1)) return;
   prompt("To what other row?  ");
-  cin >> r2;
+  if (!INPUT.read(&r2)) return;
   prompt("By what factor?  ");
-  m.addRow(r1 - 1, readFraction(), r2 - 1);
-  return m;
+  if (!INPUT.read(&factor)) return;
+  factor = approximation(factor, LITERAL_LIMIT);
+  long long modulus = stack->modulus;
+  withMatrix(stack, [&](auto &m) {
+    m.addRow(r1 - 1, entryFor(m, factor, modulus), r2 - 1);
+  });
 }
 
 
-Matrix reduce(Matrix m)
+void reduce(List stack)
 {
-  m.reduce();
-  return m;
+  if (stack == NULL || !isMatrix(stack)) {
+    error("Need a matrix on the stack for that operation.");
+    return;
+  }
+  if (stack->type == SPARSE) {
+    stack->sdata.reduce();
+  } else {
+    withMatrix(stack, [](auto &m) { m.reduce(); });
+  }
+  settle(stack);
+}
+
+
+/*  Replaces the matrix on top of the stack with its factorization (see      *
+ *  LUFactorization), which can then solve many systems with '/'.            *
+ */
+void factor(List stack)
+{
+  if (stack == NULL || !isMatrix(stack)) {
+    error("Need a matrix on the stack for that operation.");
+    return;
+  }
+  if (!isFractions(stack)) {
+    error("Only a matrix of fractions can be factored.");
+    return;
+  }
+  makeDense(stack);
+  stack->ldata = LUFactorization(stack->mdata);
+  stack->mdata = Matrix();
+  stack->type = FACTORED;
 }
 
-/*  Reads in a number, accounting for the fact that it may have been input   *
- *  as a fraction, with "/" seperating numerator and denominator.            *
+
+/*  Asks which kind of entries the matrix on top of the stack should hold,   *
+ *  and converts it to them.                                                 *
  */
-Fraction readFraction()
+void changeEntries(List stack)
+{
+  if (stack == NULL || !isMatrix(stack)) {
+    error("Need a matrix on the stack for that operation.");
+    return;
+  }
+  char kind;
+  prompt("Store entries as (f)ractions, (d)oubles, (b)ig rationals, "
+	 "or integers (m)od n?  ");
+  if (!INPUT.read(&kind)) return;
+  switch (kind) {
+  case 'f': convert(stack, MATRIX, 0);
+    break;
+  case 'd': convert(stack, REAL, 0);
+    break;
+  case 'b': convert(stack, EXACT, 0);
+    break;
+  case 'm': {
+    BigRational modulus;
+    prompt("Modulo what?  ");
+    if (!INPUT.read(&modulus)) return;
+    const BigInteger &n = modulus.getNumerator();
+    if (!modulus.isInteger() || modulus < 2 || !n.isSmall() ||
+	n.getSmall() > (unsigned long long)LLONG_MAX) {
+      error("The modulus must be a whole number from 2 to "
+	    + to_string(LLONG_MAX) + ".");
+      return;
+    }
+    convert(stack, MODULAR, (long long)n.getSmall());
+    break;
+  }
+  default: error("Unknown kind of entry.");
+  }
+}
+
+
+/*  A matrix on the stack is either a Matrix or, if few enough of its        *
+ *  entries are nonzero, a SparseMatrix (see SparseMatrix::suits).  Results  *
+ *  are settled into whichever form suits them, so the choice is never made  *
+ *  by hand.  A matrix of any other kind of entry, chosen with 'c', is kept  *
+ *  dense, in the field its node type names.                                 *
+ */
+bool isMatrix(List stack)
+{
+  switch (stack->type) {
+  case MATRIX: case SPARSE: case REAL: case EXACT: case MODULAR:
+    return true;
+  default:
+    return false;
+  }
+}
+
+
+bool isFractions(List stack)
+{
+  return stack->type == MATRIX || stack->type == SPARSE;
+}
+
+
+int matrixRows(List stack)
+{
+  if (stack->type == SPARSE) return stack->sdata.getRows();
+  int rows = 0;
+  withMatrix(stack, [&](auto &m) { rows = m.getRows(); });
+  return rows;
+}
+
+
+int matrixCols(List stack)
+{
+  if (stack->type == SPARSE) return stack->sdata.getCols();
+  int cols = 0;
+  withMatrix(stack, [&](auto &m) { cols = m.getCols(); });
+  return cols;
+}
+
+
+void makeDense(List stack)
+{
+  if (stack->type != SPARSE) return;
+  stack->mdata = stack->sdata.toMatrix();
+  stack->sdata = SparseMatrix();
+  stack->type = MATRIX;
+}
+
+
+void settle(List stack)
 {
-  long long num, den = 1;
-  char next;
-  cin >> num;
-  next = cin.peek();
-  while (isspace(next) && next != '\n') {
-    cin.get(next);
-    next = cin.peek();
+  if (stack->type == MATRIX && SparseMatrix::suits(stack->mdata)) {
+    stack->sdata = SparseMatrix(stack->mdata);
+    stack->mdata = Matrix();
+    stack->type = SPARSE;
+  } else if (stack->type == SPARSE && stack->sdata.tooDense()) {
+    makeDense(stack);
   }
-  if (next == '/') {
-    cin.get(next);
-    cin >> den;
+}
+
+
+/*  Readies two matrices to be combined, by converting one of fractions to   *
+ *  the other's kind of entry.  Returns false, with an error, if both have   *
+ *  been given different kinds.                                              *
+ */
+bool sameEntries(List left, List right)
+{
+  if (isFractions(left) && isFractions(right)) return true;
+  if (isFractions(left)) {
+    convert(left, right->type, right->modulus);
+  } else if (isFractions(right)) {
+    convert(right, left->type, left->modulus);
+  } else if (left->type != right->type || left->modulus != right->modulus) {
+    error("Matrices hold different kinds of entries; change them with 'c' "
+	  "first.");
+    return false;
   }
-  return Fraction(num, den);
+  return true;
 }
 
-/*  Reads a decimal from standard input and converts it to a fraction.       *
- *  The function expects a decimal point to have been the last thing read in.*
- *  If the "add" bool is set, the number will be added to the top number on  *
- *  the stack.  Otherwise, the number is pushed  onto the stack.             *
+
+/*  Returns a copy of m with each entry converted through a BigRational.     */
+template<class U, class T>
+BasicMatrix<U> converted(const BasicMatrix<T> &m, long long modulus)
+{
+  return convertMatrix<U>(m, [modulus](const T &entry) {
+    U result;
+    fromNumber(toNumber(entry), &result, modulus);
+    return result;
+  });
+}
+
+
+/*  Converts the matrix on top of the stack to hold the given type of node's *
+ *  kind of entry; MATRIX means fractions.                                   *
  */
-void readDecimal(List *stack, bool add)
+void convert(List stack, nodetype type, long long modulus)
 {
-  long long num = 0, den = 1;
-  long long max = LLONG_MAX / 10;
-  char next;
-  cin.get(next);
-  while (isdigit(next)) {
-    if (den < max) {
-      num *= 10;
-      den *= 10;
-      num += next - '0';
+  makeDense(stack);
+  withMatrix(stack, [&](auto &m) {
+    auto old = move(m);
+    switch (type) {
+    case REAL: stack->rdata = converted<double>(old, modulus);
+      break;
+    case EXACT: stack->edata = converted<BigRational>(old, modulus);
+      break;
+    case MODULAR: stack->zdata = converted<ModInteger>(old, modulus);
+      break;
+    default: stack->mdata = converted<Fraction>(old, modulus);
     }
-    cin.get(next);
-  }
-  cin.putback(next);
-  Fraction toAdd(num, den);
-  if (!add || *stack == NULL || (*stack)->type == MATRIX) {
-    List temp = new Node;
-    temp->type = NUMBER;
-    temp->fdata = toAdd;
-    temp->rest = *stack;
-    *stack = temp;
+  });
+  stack->type = (type == SPARSE) ? MATRIX : type;
+  stack->modulus = (type == MODULAR) ? modulus : 0;
+  settle(stack);
+}
+
+
+void scale(List stack, const BigRational &factor)
+{
+  if (stack->type == SPARSE) {
+    stack->sdata *= factor.toFraction();
+  } else {
+    long long modulus = stack->modulus;
+    withMatrix(stack, [&](auto &m) { m *= entryFor(m, factor, modulus); });
+  }
+}
+
+
+/*  Replaces left with left times right.  A sparse left side multiplies      *
+ *  either kind directly; a dense one times a sparse one is found as two     *
+ *  sparse matrices, which costs no more than the sparse one's entries       *
+ *  require.  Matrices of other entries are always dense.                    *
+ */
+void product(List left, List right)
+{
+  if (!isFractions(left)) {
+    withMatrices(left, right, [](auto &l, auto &r) { l *= r; });
+  } else if (left->type == SPARSE && right->type == SPARSE) {
+    left->sdata = left->sdata * right->sdata;
+  } else if (left->type == SPARSE) {
+    left->mdata = left->sdata * right->mdata;
+    left->sdata = SparseMatrix();
+    left->type = MATRIX;
+  } else if (right->type == SPARSE) {
+    left->sdata = SparseMatrix(left->mdata) * right->sdata;
+    left->mdata = Matrix();
+    left->type = SPARSE;
   } else {
-    (*stack)->fdata += toAdd;
+    left->mdata *= right->mdata;
+  }
+}
+
+
+/*  Calls operation on the dense matrix held by the node, whatever its       *
+ *  entries; it is instantiated for each kind, so the matrix's arithmetic    *
+ *  is compiled for that kind of entry.                                      *
+ */
+template<class Operation> void withMatrix(List stack, Operation operation)
+{
+  switch (stack->type) {
+  case REAL: operation(stack->rdata);
+    break;
+  case EXACT: operation(stack->edata);
+    break;
+  case MODULAR: operation(stack->zdata);
+    break;
+  default: operation(stack->mdata);
+  }
+}
+
+
+/*  As withMatrix, for two nodes of the same kind (see sameEntries).         */
+template<class Operation> void withMatrices(List left, List right,
+					   Operation operation)
+{
+  switch (left->type) {
+  case REAL: operation(left->rdata, right->rdata);
+    break;
+  case EXACT: operation(left->edata, right->edata);
+    break;
+  case MODULAR: operation(left->zdata, right->zdata);
+    break;
+  default: operation(left->mdata, right->mdata);
   }
 }
 
 
+/*  Entries convert to and from BigRationals, so that every kind can meet    *
+ *  the numbers on the stack.  A double converts from its mantissa and       *
+ *  exponent to the simplest fraction within a relative 1e-12 of it, so that *
+ *  rounding error does not show; an integer mod n becomes its value between *
+ *  0 and n.  A fraction becomes an integer mod n by dividing its numerator  *
+ *  by its denominator mod n, which is nan if the denominator has no         *
+ *  inverse.                                                                 *
+ */
+BigRational toNumber(const Fraction &entry)
+{
+  return BigRational(entry);
+}
+
+
+BigRational toNumber(double entry)
+{
+  if (!isfinite(entry)) return BigRational(1, 0);
+  int exponent;
+  double mantissa = frexp(entry, &exponent);
+  BigInteger numerator((long long)ldexp(mantissa, 53));
+  BigInteger denominator(1);
+  exponent -= 53;
+  if (exponent > 0) numerator <<= exponent;
+  else denominator <<= -exponent;
+  BigRational exact(numerator, denominator);
+  BigRational tolerance = exact * BigRational(1, 1000000000000LL);
+  if (tolerance.isNegative()) tolerance = -tolerance;
+  return approximation(exact, tolerance);
+}
+
+
+BigRational toNumber(const BigRational &entry)
+{
+  return entry;
+}
+
+
+BigRational toNumber(const ModInteger &entry)
+{
+  if (entry.isNan()) return BigRational(1, 0);
+  return BigRational(entry.getValue());
+}
+
+
+void fromNumber(const BigRational &value, Fraction *entry, long long)
+{
+  *entry = value.toFraction();
+}
+
+
+void fromNumber(const BigRational &value, double *entry, long long)
+{
+  *entry = value.toDouble();
+}
+
+
+void fromNumber(const BigRational &value, BigRational *entry, long long)
+{
+  *entry = value;
+}
+
+
+void fromNumber(const BigRational &value, ModInteger *entry,
+		long long modulus)
+{
+  if (value.isNan() || modulus < 1) {
+    *entry = ModInteger(0, 0);
+    return;
+  }
+  BigInteger n = value.getNumerator(), d = value.getDenominator();
+  n %= BigInteger(modulus);
+  d %= BigInteger(modulus);
+  long long top = (long long)n.getSmall(), bottom = (long long)d.getSmall();
+  *entry = ModInteger(n.isNegative() ? -top : top, modulus)
+    / ModInteger(d.isNegative() ? -bottom : bottom, modulus);
+}
+
+
+/*  Returns value as an entry of m's kind; m only selects the kind.          */
+template<class T> T entryFor(const BasicMatrix<T> &, const BigRational &value,
+			     long long modulus)
+{
+  T result;
+  fromNumber(value, &result, modulus);
+  return result;
+}
+
+
+/*  Reads in a number, in any of the forms a literal may take, to be stored  *
+ *  as a fraction.  Returns false if there was no number to read; a number   *
+ *  too large for a fraction is read as nan.                                 *
+ */
+bool readFraction(Fraction *value)
+{
+  BigRational number;
+  if (!INPUT.read(&number)) return false;
+  *value = approximation(number, LITERAL_LIMIT).toFraction();
+  return true;
+}
+
+/*  Reads a number literal from the input, and pushes it onto the stack.     *
+ *  The caller has already seen that a literal comes next.                   *
+ */
+void readNumber(List *stack)
+{
+  List temp = new Node;
+  temp->type = NUMBER;
+  INPUT.read(&temp->fdata);
+  temp->fdata = approximation(temp->fdata, LITERAL_LIMIT);
+  temp->rest = *stack;
+  *stack = temp;
+}
+
+
+/*  A limit on approximation is either a whole number, the largest           *
+ *  denominator allowed, or a number between 0 and 1, the tolerance.         *
+ */
+bool validLimit(const BigRational &limit)
+{
+  if (limit.isInteger()) return limit >= 1;
+  return limit > 0 && limit < 1;
+}
+
+
+/*  Returns the fraction closest to value whose denominator is at most the   *
+ *  limit, or the simplest fraction within the limit of value, using its     *
+ *  continued fraction.  A limit of zero leaves the value exact.             *
+ */
+BigRational approximation(const BigRational &value, const BigRational &limit)
+{
+  if (!validLimit(limit) || value.isNan()) return value;
+  if (limit.isInteger()) {
+    return value.limitDenominator(limit.getNumerator());
+  }
+  return value.simplest(limit);
+}
+
+
 bool makeDecimal(List stack)
 {
   if (stack == NULL || stack->type != NUMBER) {
     error("Topmost entry must be a number.");
     return false;
   }
-  cout << (double) stack->fdata.getNumerator() / stack->fdata.getDenominator()
-       << endl;
+  stack->fdata.printDecimal(cout, DECIMAL_DIGITS);
+  cout << endl;
   return true;
 }
 
@@ -728,6 +1394,26 @@ void printStack(List stack)
     if (stack->type == MATRIX) {
       cout << stack->mdata.getRows() << "x" << stack->mdata.getCols() << endl;
       stack->mdata.print(cout, "     ");
+    } else if (stack->type == SPARSE) {
+      cout << stack->sdata.getRows() << "x" << stack->sdata.getCols()
+	   << " sparse, " << stack->sdata.nonzeros() << " nonzero" << endl;
+      stack->sdata.print(cout, "     ");
+    } else if (stack->type == REAL) {
+      cout << stack->rdata.getRows() << "x" << stack->rdata.getCols()
+	   << " decimal" << endl;
+      stack->rdata.print(cout, "     ");
+    } else if (stack->type == EXACT) {
+      cout << stack->edata.getRows() << "x" << stack->edata.getCols()
+	   << " exact" << endl;
+      stack->edata.print(cout, "     ");
+    } else if (stack->type == MODULAR) {
+      cout << stack->zdata.getRows() << "x" << stack->zdata.getCols()
+	   << " mod " << stack->modulus << endl;
+      stack->zdata.print(cout, "     ");
+    } else if (stack->type == FACTORED) {
+      cout << stack->ldata.getRows() << "x" << stack->ldata.getCols()
+	   << " factored, rank " << stack->ldata.rank() << endl;
+      stack->ldata.print(cout, "     ");
     } else if (stack->type == NUMBER) {
       if (DECIMAL) {
 	makeDecimal(stack);
@@ -810,18 +1496,64 @@ void prompt(string message)
 void options()
 {
   char command = '\0';
+  int threads;
   do {
-    cin.get(command);
+    if (!INPUT.get(command)) command = 'q';
     switch(command) {
     case '\n':
+      cout << "Enter 'a' to set the accuracy of square roots." << endl;
       cout << "Enter 'd' to toggle fraction/decimal display." << endl;
+      cout << "Enter 'l' to approximate numbers as they are entered." << endl;
+      cout << "Enter 'n' to set the number of decimal places shown." << endl;
       cout << "Enter 'p' to toggle prompts." << endl;
+      cout << "Enter 't' to set the number of threads for matrices." << endl;
       cout << "Enter 'r' to return to the calculator." << endl;
       break;
+    case 'a':
+      prompt("How many digits of accuracy?  ");
+      if (!INPUT.read(&ROOT_DIGITS) || ROOT_DIGITS < 0) {
+	ROOT_DIGITS = 15;
+      }
+      cout << "Square roots that are not exact will now be accurate to "
+	   << ROOT_DIGITS << " digits." << endl;
+      break;
+    case 'n':
+      prompt("How many decimal places?  ");
+      if (!INPUT.read(&DECIMAL_DIGITS) || DECIMAL_DIGITS < 0) {
+	DECIMAL_DIGITS = 9;
+      }
+      cout << "Decimals will now be shown to at most " << DECIMAL_DIGITS
+	   << " places." << endl;
+      break;
+    case 'l':
+      prompt("Largest denominator, or tolerance (0 for exact)?  ");
+      if (!INPUT.read(&LITERAL_LIMIT) || !validLimit(LITERAL_LIMIT)) {
+	LITERAL_LIMIT = 0;
+      }
+      if (LITERAL_LIMIT == 0) {
+	cout << "Numbers will now be entered exactly." << endl;
+      } else {
+	cout << "Numbers will now be approximated to "
+	     << (LITERAL_LIMIT.isInteger() ? "a denominator of at most " :
+		 "within ");
+	LITERAL_LIMIT.print(cout);
+	cout << "." << endl;
+      }
+      break;
     case 'd': DECIMAL = !DECIMAL;
       cout << "Numbers will now be displayed as "
 	   << (DECIMAL ? "decimal" : "fraction") << "s." << endl;
       break;
+    case 't':
+      prompt("How many threads?  ");
+      if (!INPUT.read(&threads) || threads < 1) {
+	threads = thread::hardware_concurrency();
+      }
+      ThreadPool::shared().resize(threads);
+      cout << "Matrix arithmetic will now use " << ThreadPool::shared().size()
+	   << " thread" << (ThreadPool::shared().size() == 1 ? "" : "s") << "."
+	   << endl;
+      break;
     case 'p': PROMPT = !PROMPT;
       cout << "Prompts are now " << (PROMPT ? "en" : "dis") << "abled." <<endl;
       break;
@@ -831,7 +1563,7 @@ void options()
     }
   } while (command != 'r' && command != 'q');
   if (command == 'q') {
-    cin.putback(command);
+    INPUT.putback();
   }
 }
 
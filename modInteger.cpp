@@ -0,0 +1,18 @@
+/*---------------------------------------------------------------------------*\
+ *                              modInteger.cpp                               *
+ *                   Implementation of the ModInteger class                  *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    The arithmetic is inline, in modInteger.h; products are taken at 128   *
+ *    bits, so they are reduced without ever wrapping around.                *
+\*---------------------------------------------------------------------------*/
+#include<iostream>
+#include "modInteger.h"
+using namespace std;
+
+
+void ModInteger::print(ostream &stream) const
+{
+  if (isNan()) stream << "nan";
+  else stream << value;
+}
@@ -0,0 +1,273 @@
+/*---------------------------------------------------------------------------*\
+ *                               modInteger.h                                *
+ *                     Interface for the ModInteger class                    *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Represents an integer modulo some modulus, such as 3 mod 7, with the   *
+ *      same arithmetic interface as Fraction, so that a matrix can hold     *
+ *      them in its place.  Arithmetic modulo a prime is exact and never     *
+ *      grows, so a matrix of them reduces in constant time per operation,   *
+ *      however large the entries of the original would have become.         *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Each number carries its own modulus, which may be up to LLONG_MAX.     *
+ *      A number made from an integer alone, such as the zeros a new matrix  *
+ *      starts with, has no modulus yet: it is an ordinary integer, and      *
+ *      takes the modulus of whatever it is combined with.                   *
+ *   -Combining numbers with different moduli, dividing by a number that     *
+ *      has no inverse (one sharing a factor with the modulus), or an        *
+ *      ordinary result too large for a long long, gives nan, which spreads  *
+ *      through any later arithmetic as with Fraction.                       *
+ *   -Numbers are kept reduced, between 0 and the modulus, so equal numbers  *
+ *      are stored identically.                                              *
+\*---------------------------------------------------------------------------*/
+#ifndef MODINTEGER_CLASS_INCLUDED
+#define MODINTEGER_CLASS_INCLUDED
+#include<climits>
+#include<iostream>
+using namespace std;
+
+class ModInteger
+{
+ public:
+  /*  Constructors                                                           *
+   *  Default constructor initializes the number to zero, with no modulus.   *
+   *  Second constructor initializes to an integer, with no modulus.         *
+   *  Third constructor initializes to number mod modulus; a modulus less    *
+   *    than 1 gives nan.                                                    *
+   */
+  ModInteger();
+  ModInteger(long long number);
+  ModInteger(long long number, long long modulus);
+
+  /*  Return the value (between 0 and the modulus, if there is one), and the *
+   *    modulus, which is 0 if there is none.                                *
+   */
+  long long getValue() const;
+  long long getModulus() const;
+
+  /*  Returns whether the number is nan.                                     *
+   */
+  bool isNan() const;
+
+  /*  Arithmetic operators work as with Fraction; division multiplies by the *
+   *    inverse.  Non-assigning operators are defined below the class.       *
+   */
+  ModInteger operator-() const;
+  ModInteger &operator+=(const ModInteger &rhs);
+  ModInteger &operator-=(const ModInteger &rhs);
+  ModInteger &operator*=(const ModInteger &rhs);
+  ModInteger &operator/=(const ModInteger &rhs);
+
+  /*  Numbers are equal if they are congruent under their common modulus.    *
+   *    nan equals nothing.                                                  *
+   */
+  bool operator==(const ModInteger &rhs) const;
+
+  /*  Returns the inverse of the number: that which multiplies it to 1.      *
+   *    Without a modulus, only 1 and -1 have one; otherwise returns nan.    *
+   */
+  ModInteger reciprocal() const;
+
+  /*  Prints the value, or "nan".                                            *
+   */
+  void print(ostream &stream) const;
+
+ private:
+  long long value;
+  long long modulus;           /* 0 for none, and -1 for nan */
+
+  typedef __int128 int128;
+
+  bool common(const ModInteger &rhs, long long *result) const;
+  void set(int128 number, long long modulus);
+};
+
+
+/*  Arithmetic is defined here, so that it is inlined into the loops of a    *
+ *    matrix of ModIntegers.  Only printing is in modInteger.cpp.            *
+ */
+inline ModInteger::ModInteger() : value(0), modulus(0)
+{
+}
+
+
+inline ModInteger::ModInteger(long long number) : value(0), modulus(0)
+{
+  set(number, 0);
+}
+
+
+inline ModInteger::ModInteger(long long number, long long modulus)
+  : value(0), modulus(-1)
+{
+  if (modulus >= 1) set(number, modulus);
+}
+
+
+inline long long ModInteger::getValue() const
+{
+  return value;
+}
+
+
+inline long long ModInteger::getModulus() const
+{
+  return (modulus < 0) ? 0 : modulus;
+}
+
+
+inline bool ModInteger::isNan() const
+{
+  return modulus < 0;
+}
+
+
+/*  Sets the number to the given one, reduced by the given modulus if it is  *
+ *    not 0.  An unreduced number must fit in a long long, but not be        *
+ *    LLONG_MIN, so that it can always be negated; otherwise it is nan.      *
+ */
+inline void ModInteger::set(int128 number, long long modulus)
+{
+  if (modulus == 0) {
+    if (number > LLONG_MAX || number < -LLONG_MAX) {
+      value = 0;
+      this->modulus = -1;
+      return;
+    }
+    value = (long long)number;
+  } else {
+    number %= modulus;
+    value = (long long)((number < 0) ? number + modulus : number);
+  }
+  this->modulus = modulus;
+}
+
+
+/*  Finds the modulus under which two numbers combine: that of either, if    *
+ *    only one has one.  Returns false if either is nan, or they differ.     *
+ */
+inline bool ModInteger::common(const ModInteger &rhs, long long *result) const
+{
+  if (isNan() || rhs.isNan()) return false;
+  if (modulus != 0 && rhs.modulus != 0 && modulus != rhs.modulus) return false;
+  *result = (modulus != 0) ? modulus : rhs.modulus;
+  return true;
+}
+
+
+inline ModInteger ModInteger::operator-() const
+{
+  ModInteger result(*this);
+  if (!isNan()) result.set(-(int128)value, modulus);
+  return result;
+}
+
+
+inline ModInteger &ModInteger::operator+=(const ModInteger &rhs)
+{
+  long long m;
+  if (common(rhs, &m)) set((int128)value + rhs.value, m);
+  else *this = ModInteger(0, 0);
+  return *this;
+}
+
+
+inline ModInteger &ModInteger::operator-=(const ModInteger &rhs)
+{
+  long long m;
+  if (common(rhs, &m)) set((int128)value - rhs.value, m);
+  else *this = ModInteger(0, 0);
+  return *this;
+}
+
+
+inline ModInteger &ModInteger::operator*=(const ModInteger &rhs)
+{
+  long long m;
+  if (common(rhs, &m)) set((int128)value * rhs.value, m);
+  else *this = ModInteger(0, 0);
+  return *this;
+}
+
+
+inline ModInteger &ModInteger::operator/=(const ModInteger &rhs)
+{
+  return operator*=(rhs.reciprocal());
+}
+
+
+/*  An unreduced number is compared after reducing it by the other's         *
+ *    modulus.                                                               *
+ */
+inline bool ModInteger::operator==(const ModInteger &rhs) const
+{
+  long long m;
+  if (!common(rhs, &m)) return false;
+  if (m == 0) return value == rhs.value;
+  return ModInteger(value, m).value == ModInteger(rhs.value, m).value;
+}
+
+
+/*  The inverse is found by the extended Euclidean algorithm, which keeps    *
+ *    the coefficient of the number in each remainder; once the remainder is *
+ *    their GCD, which must be 1, that coefficient is the inverse.           *
+ */
+inline ModInteger ModInteger::reciprocal() const
+{
+  if (isNan()) return *this;
+  if (modulus == 0) {
+    return (value == 1 || value == -1) ? *this : ModInteger(0, 0);
+  }
+  long long r0 = modulus, r1 = value;
+  int128 t0 = 0, t1 = 1;
+  while (r1 != 0) {
+    long long q = r0 / r1;
+    long long r2 = r0 - q * r1;
+    int128 t2 = t0 - q * t1;
+    r0 = r1;
+    r1 = r2;
+    t0 = t1;
+    t1 = t2;
+  }
+  if (r0 != 1) return ModInteger(0, 0);
+  ModInteger result;
+  result.set(t0, modulus);
+  return result;
+}
+
+
+/*  The following define further operators in terms of the ones declared     *
+ *    within the class.  Integers convert to ModIntegers implicitly, so      *
+ *    these work between the two in any order.                               *
+ */
+inline ModInteger operator*(ModInteger lhs, const ModInteger &rhs)
+{
+  lhs *= rhs;
+  return lhs;
+}
+
+inline ModInteger operator/(ModInteger lhs, const ModInteger &rhs)
+{
+  lhs /= rhs;
+  return lhs;
+}
+
+inline ModInteger operator+(ModInteger lhs, const ModInteger &rhs)
+{
+  lhs += rhs;
+  return lhs;
+}
+
+inline ModInteger operator-(ModInteger lhs, const ModInteger &rhs)
+{
+  lhs -= rhs;
+  return lhs;
+}
+
+inline bool operator!=(const ModInteger &lhs, const ModInteger &rhs)
+{
+  return !(lhs == rhs);
+}
+
+#endif
@@ -0,0 +1,649 @@
+/*---------------------------------------------------------------------------*\
+ *                              sparseMatrix.cpp                             *
+ *                   Implementation of the SparseMatrix class                *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    The nonzero entries are kept in compressed sparse rows: one array of   *
+ *    values and one of their columns, row after row, and the index in them  *
+ *    at which each row starts.  Walking along a row is then as cheap as in  *
+ *    a Matrix, but finding an entry in a given column takes a search.       *
+ *    Exact zeros are never stored, so the number of entries kept is the     *
+ *    number of nonzero ones.                                                *
+\*---------------------------------------------------------------------------*/
+#include<algorithm>
+#include<iostream>
+#include<string>
+#include<vector>
+#include "fraction.h"
+#include "matrix.h"
+#include "threadPool.h"
+#include "sparseMatrix.h"
+using namespace std;
+
+/*  A matrix is worth keeping sparse when at most one entry in SPARSE_RATIO  *
+ *    is nonzero, and is returned to a Matrix once more than one in          *
+ *    DENSE_RATIO is.  Matrices with fewer than MIN_SPARSE_ENTRIES entries   *
+ *    are small enough that the difference does not matter, and are always   *
+ *    kept dense.                                                            *
+ */
+static const int SPARSE_RATIO = 10;
+static const int DENSE_RATIO = 4;
+static const long long MIN_SPARSE_ENTRIES = 256;
+
+
+/*  The eliminations take the rows apart, since they grow and shrink with    *
+ *    every step, and put them back together at the end.                     *
+ */
+struct Entry {
+  int col;
+  Fraction value;
+};
+typedef vector<Entry> Row;
+
+
+static vector<Row> toRows(int rows, const vector<int> &rowStarts,
+			  const vector<int> &columns,
+			  const vector<Fraction> &values)
+{
+  vector<Row> rowList(rows);
+  for (int i = 0; i < rows; i++) {
+    for (int k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+      rowList[i].push_back(Entry{columns[k], values[k]});
+    }
+  }
+  return rowList;
+}
+
+
+/*  Replaces the entries with those of the given rows, leaving out zeros.    */
+static void fromRows(const vector<Row> &rowList, vector<int> *rowStarts,
+		     vector<int> *columns, vector<Fraction> *values)
+{
+  rowStarts->assign(1, 0);
+  columns->clear();
+  values->clear();
+  for (size_t i = 0; i < rowList.size(); i++) {
+    for (size_t k = 0; k < rowList[i].size(); k++) {
+      if (rowList[i][k].value != 0) {
+	columns->push_back(rowList[i][k].col);
+	values->push_back(rowList[i][k].value);
+      }
+    }
+    rowStarts->push_back(values->size());
+  }
+}
+
+
+
+SparseMatrix::SparseMatrix()
+{
+  rows = 0;
+  cols = 0;
+  rowStarts.push_back(0);
+}
+
+
+SparseMatrix::SparseMatrix(int rows, int cols)
+{
+  if (rows < 0 || cols < 0) rows = cols = 0;
+  this->rows = rows;
+  this->cols = cols;
+  rowStarts.assign(rows + 1, 0);
+}
+
+
+SparseMatrix::SparseMatrix(const Matrix &m)
+{
+  rows = m.rows;
+  cols = m.cols;
+  rowStarts.push_back(0);
+  for (int i = 0; i < rows; i++) {
+    const Fraction *row = m.rowStart(i);
+    for (int j = 0; j < cols; j++) {
+      if (row[j] != 0) {
+	columns.push_back(j);
+	values.push_back(row[j]);
+      }
+    }
+    rowStarts.push_back(values.size());
+  }
+}
+
+
+Matrix SparseMatrix::toMatrix() const
+{
+  Matrix result(rows, cols);
+  for (int i = 0; i < rows; i++) {
+    Fraction *row = result.rowStart(i);
+    for (int k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+      row[columns[k]] = values[k];
+    }
+  }
+  return result;
+}
+
+
+int SparseMatrix::getRows() const
+{
+  return rows;
+}
+
+
+int SparseMatrix::getCols() const
+{
+  return cols;
+}
+
+
+int SparseMatrix::nonzeros() const
+{
+  return values.size();
+}
+
+
+/*  A row's columns are in order, so the entry is found by binary search.    */
+Fraction SparseMatrix::get(int row, int col) const
+{
+  if (row < 0 || row >= rows || col < 0 || col >= cols) return Fraction(1, 0);
+  const int *begin = columns.data() + rowStarts[row];
+  const int *end = columns.data() + rowStarts[row + 1];
+  const int *found = lower_bound(begin, end, col);
+  if (found == end || *found != col) return 0;
+  return values[found - columns.data()];
+}
+
+
+/*  Counting stops as soon as there are too many nonzero entries.            */
+bool SparseMatrix::suits(const Matrix &m)
+{
+  long long size = (long long)m.rows * m.cols;
+  if (size < MIN_SPARSE_ENTRIES) return false;
+  long long allowed = size / SPARSE_RATIO;
+  long long count = 0;
+  for (long long i = 0; i < size; i++) {
+    if (m.entries[i] != 0 && ++count > allowed) return false;
+  }
+  return true;
+}
+
+
+bool SparseMatrix::tooDense() const
+{
+  long long size = (long long)rows * cols;
+  return size < MIN_SPARSE_ENTRIES ||
+	 (long long)values.size() * DENSE_RATIO > size;
+}
+
+
+SparseMatrix SparseMatrix::operator-() const
+{
+  SparseMatrix result(*this);
+  for (size_t k = 0; k < values.size(); k++) {
+    result.values[k] = -values[k];
+  }
+  return result;
+}
+
+
+SparseMatrix &SparseMatrix::operator+=(const SparseMatrix &rval)
+{
+  if (rows != rval.rows || cols != rval.cols) return *this;
+  *this = combine(rval, false);
+  return *this;
+}
+
+
+SparseMatrix &SparseMatrix::operator-=(const SparseMatrix &rval)
+{
+  if (rows != rval.rows || cols != rval.cols) return *this;
+  *this = combine(rval, true);
+  return *this;
+}
+
+
+/*  Only multiplying by zero can turn entries into zeros, which are then     *
+ *    dropped.  Multiplying by nan makes every entry nan, zeros included.    *
+ */
+SparseMatrix &SparseMatrix::operator*=(const Fraction &rval)
+{
+  if (rval.isNan()) {
+    Matrix dense = toMatrix();
+    dense *= rval;
+    *this = SparseMatrix(dense);
+    return *this;
+  }
+  for (size_t k = 0; k < values.size(); k++) {
+    values[k] *= rval;
+  }
+  if (rval == 0) {
+    fromRows(toRows(rows, rowStarts, columns, values), &rowStarts,
+	     &columns, &values);
+  }
+  return *this;
+}
+
+
+/*  Each row of the product is a combination of the right matrix's rows, one *
+ *    for each entry in the left row, and is gathered in a full-length       *
+ *    array, marking the columns reached.  Each entry has its products added *
+ *    in order along the shared dimension, as in Matrix's product, skipping  *
+ *    only those with a zero factor.  Rows are independent, so they are      *
+ *    split across the threads.                                              *
+ *  A zero times nan is nan, so with nan in either matrix, the skipped       *
+ *    products matter, and the product is left to Matrix.                    *
+ */
+SparseMatrix SparseMatrix::operator*(const SparseMatrix &rval) const
+{
+  if (cols != rval.rows) return SparseMatrix();
+  if (hasNan() || rval.hasNan()) {
+    return SparseMatrix(toMatrix() * rval.toMatrix());
+  }
+  vector<Row> result(rows);
+  long long work = 1;
+  if (rows > 0 && rval.rows > 0) {
+    work += (long long)nonzeros() * rval.nonzeros() / rows / rval.rows;
+  }
+  ThreadPool::shared().parallelFor(rows, ThreadPool::minBlock(work),
+				   [&](int begin, int end) {
+    vector<Fraction> sums(rval.cols);
+    vector<bool> reached(rval.cols, false);
+    vector<int> pattern;
+    for (int i = begin; i < end; i++) {
+      pattern.clear();
+      for (int k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+	int inner = columns[k];
+	for (int l = rval.rowStarts[inner]; l < rval.rowStarts[inner + 1];
+	     l++) {
+	  int j = rval.columns[l];
+	  if (!reached[j]) {
+	    reached[j] = true;
+	    pattern.push_back(j);
+	    sums[j] = values[k] * rval.values[l];
+	  } else {
+	    sums[j] += values[k] * rval.values[l];
+	  }
+	}
+      }
+      sort(pattern.begin(), pattern.end());
+      for (size_t p = 0; p < pattern.size(); p++) {
+	int j = pattern[p];
+	if (sums[j] != 0) result[i].push_back(Entry{j, sums[j]});
+	reached[j] = false;
+      }
+    }
+  });
+  SparseMatrix product(rows, rval.cols);
+  fromRows(result, &product.rowStarts, &product.columns, &product.values);
+  return product;
+}
+
+
+/*  Each row of the product adds up the right matrix's rows, scaled by the   *
+ *    entries of the left row, in order along the shared dimension.  As      *
+ *    above, a product with nan in it is left to Matrix.                     *
+ */
+Matrix SparseMatrix::operator*(const Matrix &rval) const
+{
+  if (cols != rval.rows) return Matrix();
+  if (hasNan() || rval.hasNan()) return toMatrix() * rval;
+  Matrix result(rows, rval.cols);
+  long long work = 1;
+  if (rows > 0) work += (long long)nonzeros() * rval.cols / rows;
+  ThreadPool::shared().parallelFor(rows, ThreadPool::minBlock(work),
+				   [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      Fraction *sums = result.rowStart(i);
+      for (int k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+	const Fraction *row = rval.rowStart(columns[k]);
+	for (int j = 0; j < rval.cols; j++) {
+	  sums[j] += values[k] * row[j];
+	}
+      }
+    }
+  });
+  return result;
+}
+
+
+/*  Entries are sorted into their columns by counting how many each column   *
+ *    has; rows are taken in order, so each new row comes out in order too.  *
+ */
+void SparseMatrix::transpose()
+{
+  vector<int> starts(cols + 1, 0);
+  for (size_t k = 0; k < columns.size(); k++) {
+    starts[columns[k] + 1]++;
+  }
+  for (int j = 0; j < cols; j++) {
+    starts[j + 1] += starts[j];
+  }
+  vector<int> next(starts.begin(), starts.end() - 1);
+  vector<int> newColumns(columns.size());
+  vector<Fraction> newValues(values.size());
+  for (int i = 0; i < rows; i++) {
+    for (int k = rowStarts[i]; k < rowStarts[i + 1]; k++) {
+      int position = next[columns[k]]++;
+      newColumns[position] = i;
+      newValues[position] = values[k];
+    }
+  }
+  swap(rows, cols);
+  rowStarts.swap(starts);
+  columns.swap(newColumns);
+  values.swap(newValues);
+}
+
+
+/*  Sets result to row minus factor times pivotRow.  The column being        *
+ *    eliminated is left out of the result, rather than computed, so that    *
+ *    it is gone even if the arithmetic overflows.                           *
+ */
+static void subtractRow(const Row &row, const Fraction &factor,
+			const Row &pivotRow, int eliminated, Row *result)
+{
+  result->clear();
+  size_t a = 0, b = 0;
+  while (a < row.size() || b < pivotRow.size()) {
+    Entry next;
+    if (b == pivotRow.size() ||
+	(a < row.size() && row[a].col < pivotRow[b].col)) {
+      next = row[a++];
+    } else if (a == row.size() || pivotRow[b].col < row[a].col) {
+      next.col = pivotRow[b].col;
+      next.value = -(factor * pivotRow[b++].value);
+    } else {
+      next.col = row[a].col;
+      next.value = row[a++].value - factor * pivotRow[b++].value;
+    }
+    if (next.col != eliminated && next.value != 0) result->push_back(next);
+  }
+}
+
+
+/*  Gives a row's entry in the given column, by binary search.               */
+static Fraction entry(const Row &row, int col)
+{
+  size_t low = 0, high = row.size();
+  while (low < high) {
+    size_t middle = (low + high) / 2;
+    if (row[middle].col < col) low = middle + 1;
+    else high = middle;
+  }
+  if (low < row.size() && row[low].col == col) return row[low].value;
+  return 0;
+}
+
+
+/*  Gaussian elimination, as in Matrix::determinant(), but with the pivots   *
+ *    chosen to limit fill-in, the zeros that elimination turns nonzero.     *
+ *    Each step takes the remaining column with the fewest nonzero entries,  *
+ *    and within it the row with the fewest, after Markowitz: only the rows  *
+ *    with an entry in that column change, and each gains at most the pivot  *
+ *    row's entries.  The number of entries in each column is kept up to     *
+ *    date as rows change, along with a list of the rows that may have one.  *
+ *  The determinant is then the product of the pivots, negated if taking     *
+ *    them in that order permuted the columns oddly against the rows.        *
+ *  Returns false if the determinant overflowed.                             *
+ */
+static bool sparseDeterminant(vector<Row> rowList, Fraction *determinant)
+{
+  int size = rowList.size();
+  vector<vector<int> > colRows(size);
+  vector<int> colCount(size, 0);
+  for (int i = 0; i < size; i++) {
+    for (size_t k = 0; k < rowList[i].size(); k++) {
+      colRows[rowList[i][k].col].push_back(i);
+      colCount[rowList[i][k].col]++;
+    }
+  }
+  vector<bool> rowDone(size, false), colDone(size, false);
+  vector<int> pivotCol(size);
+  vector<int> seen(size, -1);
+  vector<int> candidates;
+  Row scratch;
+  Fraction result = 1;
+  for (int step = 0; step < size; step++) {
+    int j = -1;
+    for (int c = 0; c < size; c++) {
+      if (!colDone[c] && (j < 0 || colCount[c] < colCount[j])) j = c;
+    }
+    if (colCount[j] == 0) {
+      *determinant = 0;
+      return true;
+    }
+    candidates.clear();
+    int p = -1;
+    for (size_t k = 0; k < colRows[j].size(); k++) {
+      int i = colRows[j][k];
+      if (rowDone[i] || seen[i] == step || entry(rowList[i], j) == 0) continue;
+      seen[i] = step;
+      candidates.push_back(i);
+      if (p < 0 || rowList[i].size() < rowList[p].size()) p = i;
+    }
+    const Row &pivotRow = rowList[p];
+    Fraction pivot = entry(pivotRow, j);
+    result *= pivot;
+    rowDone[p] = colDone[j] = true;
+    pivotCol[p] = j;
+    for (size_t k = 0; k < pivotRow.size(); k++) {
+      colCount[pivotRow[k].col]--;
+    }
+
+    for (size_t c = 0; c < candidates.size(); c++) {
+      int i = candidates[c];
+      if (i == p) continue;
+      Row &row = rowList[i];
+      subtractRow(row, entry(row, j) / pivot, pivotRow, j, &scratch);
+      size_t a = 0, b = 0;
+      while (a < row.size() || b < scratch.size()) {
+	if (b == scratch.size() ||
+	    (a < row.size() && row[a].col < scratch[b].col)) {
+	  colCount[row[a++].col]--;
+	} else if (a == row.size() || scratch[b].col < row[a].col) {
+	  colCount[scratch[b].col]++;
+	  colRows[scratch[b++].col].push_back(i);
+	} else {
+	  a++;
+	  b++;
+	}
+      }
+      row.swap(scratch);
+    }
+    Row().swap(rowList[p]);
+    vector<int>().swap(colRows[j]);
+  }
+
+  vector<bool> visited(size, false);
+  for (int i = 0; i < size; i++) {
+    if (visited[i]) continue;
+    int length = 0;
+    for (int k = i; !visited[k]; k = pivotCol[k]) {
+      visited[k] = true;
+      length++;
+    }
+    if (length % 2 == 0) result = -result;
+  }
+  *determinant = result;
+  return !result.isNan();
+}
+
+
+/*  Gauss-Jordan elimination, as in Matrix::reduce(), in two passes.         *
+ *  The first brings the matrix to echelon form.  Rows are kept in lists by  *
+ *    the column of their first entry; for each column in turn, the row in   *
+ *    its list with the fewest entries becomes the pivot row, which keeps    *
+ *    fill-in down, and is subtracted from the others, which move on to the  *
+ *    lists for their new first columns.  Reduced echelon form is unique, so *
+ *    the choice of pivot does not change the result.                        *
+ *  The second pass clears the entries above the pivots, from the bottom     *
+ *    up.  Each pivot row below is already reduced, with nothing in the      *
+ *    other pivots' columns, so a row needs each of them subtracted only     *
+ *    once, for the pivot columns it started with.  The row is gathered in a *
+ *    full-length array while that is done.                                  *
+ *  Returns false if anything overflowed.                                    *
+ */
+static bool sparseReduce(vector<Row> &rowList, int cols)
+{
+  int rows = rowList.size();
+  vector<vector<int> > byLead(cols);
+  for (int i = 0; i < rows; i++) {
+    if (!rowList[i].empty()) byLead[rowList[i][0].col].push_back(i);
+  }
+
+  vector<int> pivots;
+  vector<int> pivotOf(cols, -1);
+  Row scratch;
+  for (int j = 0; j < cols; j++) {
+    vector<int> &candidates = byLead[j];
+    if (candidates.empty()) continue;
+    int p = candidates[0];
+    for (size_t c = 1; c < candidates.size(); c++) {
+      if (rowList[candidates[c]].size() < rowList[p].size()) p = candidates[c];
+    }
+    Row &pivotRow = rowList[p];
+    Fraction scale = pivotRow[0].value.reciprocal();
+    for (size_t k = 0; k < pivotRow.size(); k++) {
+      pivotRow[k].value *= scale;
+    }
+    for (size_t c = 0; c < candidates.size(); c++) {
+      int i = candidates[c];
+      if (i == p) continue;
+      subtractRow(rowList[i], rowList[i][0].value, pivotRow, j, &scratch);
+      rowList[i].swap(scratch);
+      if (!rowList[i].empty()) byLead[rowList[i][0].col].push_back(i);
+    }
+    vector<int>().swap(candidates);
+    pivots.push_back(p);
+    pivotOf[j] = p;
+  }
+
+  vector<Fraction> sums(cols);
+  vector<bool> reached(cols, false);
+  vector<int> pattern;
+  for (int r = pivots.size() - 1; r >= 0; r--) {
+    Row &row = rowList[pivots[r]];
+    pattern.clear();
+    for (size_t k = 0; k < row.size(); k++) {
+      sums[row[k].col] = row[k].value;
+      reached[row[k].col] = true;
+      pattern.push_back(row[k].col);
+    }
+    for (size_t k = 1; k < row.size(); k++) {
+      int c = row[k].col;
+      if (pivotOf[c] < 0) continue;
+      Fraction factor = sums[c];
+      const Row &below = rowList[pivotOf[c]];
+      for (size_t l = 1; l < below.size(); l++) {
+	int col = below[l].col;
+	if (!reached[col]) {
+	  reached[col] = true;
+	  pattern.push_back(col);
+	  sums[col] = -(factor * below[l].value);
+	} else {
+	  sums[col] -= factor * below[l].value;
+	}
+      }
+      sums[c] = 0;
+    }
+    sort(pattern.begin(), pattern.end());
+    row.clear();
+    for (size_t k = 0; k < pattern.size(); k++) {
+      int col = pattern[k];
+      if (sums[col] != 0) row.push_back(Entry{col, sums[col]});
+      reached[col] = false;
+    }
+  }
+
+  vector<Row > reduced(rows);
+  for (size_t r = 0; r < pivots.size(); r++) {
+    reduced[r].swap(rowList[pivots[r]]);
+  }
+  rowList.swap(reduced);
+  for (int i = 0; i < rows; i++) {
+    for (size_t k = 0; k < rowList[i].size(); k++) {
+      if (rowList[i][k].value.isNan()) return false;
+    }
+  }
+  return true;
+}
+
+
+/*  If the elimination overflows, where Matrix's might not (its integer      *
+ *    matrices never do), the determinant is found by Matrix instead.  So is *
+ *    that of a matrix with nan in it, since nan spreads through zeros there *
+ *    too.                                                                   *
+ */
+Fraction SparseMatrix::determinant() const
+{
+  if (rows != cols) return Fraction(1, 0);
+  Fraction result;
+  if (hasNan() ||
+      !sparseDeterminant(toRows(rows, rowStarts, columns, values), &result)) {
+    return toMatrix().determinant();
+  }
+  return result;
+}
+
+
+/*  As with the determinant, Matrix takes over if the elimination overflows, *
+ *    or if there is nan to begin with.                                      *
+ */
+void SparseMatrix::reduce()
+{
+  vector<Row> rowList = toRows(rows, rowStarts, columns, values);
+  if (hasNan() || !sparseReduce(rowList, cols)) {
+    Matrix dense = toMatrix();
+    dense.reduce();
+    *this = SparseMatrix(dense);
+    return;
+  }
+  fromRows(rowList, &rowStarts, &columns, &values);
+}
+
+
+void SparseMatrix::print(ostream &stream, const string &lineStart) const
+{
+  toMatrix().print(stream, lineStart);
+}
+
+
+/*  Adds or subtracts rval, merging each pair of rows by column.             */
+SparseMatrix SparseMatrix::combine(const SparseMatrix &rval,
+				   bool subtract) const
+{
+  SparseMatrix result(rows, cols);
+  for (int i = 0; i < rows; i++) {
+    int a = rowStarts[i], b = rval.rowStarts[i];
+    int aEnd = rowStarts[i + 1], bEnd = rval.rowStarts[i + 1];
+    while (a < aEnd || b < bEnd) {
+      int col;
+      Fraction value;
+      if (b == bEnd || (a < aEnd && columns[a] < rval.columns[b])) {
+	col = columns[a];
+	value = values[a++];
+      } else if (a == aEnd || rval.columns[b] < columns[a]) {
+	col = rval.columns[b];
+	value = subtract ? -rval.values[b++] : rval.values[b++];
+      } else {
+	col = columns[a];
+	value = subtract ? values[a++] - rval.values[b++]
+			 : values[a++] + rval.values[b++];
+      }
+      if (value != 0) {
+	result.columns.push_back(col);
+	result.values.push_back(value);
+      }
+    }
+    result.rowStarts[i + 1] = result.values.size();
+  }
+  return result;
+}
+
+
+bool SparseMatrix::hasNan() const
+{
+  for (size_t k = 0; k < values.size(); k++) {
+    if (values[k].isNan()) return true;
+  }
+  return false;
+}
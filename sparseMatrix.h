@@ -0,0 +1,111 @@
+/*---------------------------------------------------------------------------*\
+ *                               sparseMatrix.h                              *
+ *                    Interface for the SparseMatrix class                   *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Represents a matrix of rational numbers, like Matrix, but stores only  *
+ *      the entries that are not zero.  A matrix that is mostly zeros, such  *
+ *      as an incidence or transition matrix, then takes space, and time to  *
+ *      work with, in proportion to its nonzero entries rather than to its   *
+ *      size.                                                                *
+ *    Defines addition, subtraction, scalar and matrix multiplication,       *
+ *      transposing, the determinant and row reduction.  Anything else is    *
+ *      done by converting to a Matrix and back.                             *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -The results are those that Matrix gives.  Eliminations choose their    *
+ *      pivots to keep the rows sparse (see sparseMatrix.cpp), and if that   *
+ *      overflows, the work is redone as a Matrix; so the only difference is *
+ *      that they can be exact where Matrix's overflow into nan.  Products   *
+ *      and eliminations with nan in them are left to Matrix, since nan      *
+ *      spreads through zeros too.                                           *
+ *   -suits() and tooDense() say which form a matrix is best kept in.  The   *
+ *      two thresholds are apart, so that a matrix near one of them is not   *
+ *      converted back and forth.                                            *
+ *   -Invalid operations leave the matrix unchanged, or give the empty       *
+ *      matrix, as with Matrix.                                              *
+\*---------------------------------------------------------------------------*/
+#ifndef SPARSEMATRIX_CLASS_INCLUDED
+#define SPARSEMATRIX_CLASS_INCLUDED
+#include<iostream>
+#include<string>
+#include<vector>
+#include "fraction.h"
+#include "matrix.h"
+using namespace std;
+
+class SparseMatrix
+{
+ public:
+  /*  Constructors                                                           *
+   *  Default constructor creates an empty matrix.                           *
+   *  Second constructor creates a zero matrix of the given size.            *
+   *  Third constructor keeps the nonzero entries of a Matrix.               *
+   */
+  SparseMatrix();
+  SparseMatrix(int rows, int cols);
+  SparseMatrix(const Matrix &m);
+
+  /*  Returns the same matrix, with every entry stored.                      *
+   */
+  Matrix toMatrix() const;
+
+  /*  Give the dimensions of the matrix, and how many entries are stored.    *
+   */
+  int getRows() const;
+  int getCols() const;
+  int nonzeros() const;
+
+  /*  Gives the value at the given coordinates, or nan if they are invalid.  *
+   */
+  Fraction get(int row, int col) const;
+
+  /*  Whether a Matrix has few enough nonzero entries to be worth storing    *
+   *    sparsely, and whether this one has too many to be.                   *
+   */
+  static bool suits(const Matrix &m);
+  bool tooDense() const;
+
+  /*  Arithmetic is defined as for Matrix.  A sparse matrix can multiply a   *
+   *    Matrix, giving a Matrix, as products with a dense right side         *
+   *    usually are.                                                         *
+   */
+  SparseMatrix operator-() const;
+  SparseMatrix &operator+=(const SparseMatrix &rval);
+  SparseMatrix &operator-=(const SparseMatrix &rval);
+  SparseMatrix &operator*=(const Fraction &rval);
+  SparseMatrix operator*(const SparseMatrix &rval) const;
+  Matrix operator*(const Matrix &rval) const;
+
+  /*  Turns the matrix into its transpose.                                   *
+   */
+  void transpose();
+
+  /*  Returns the determinant, which is nan for a matrix that is not square. *
+   */
+  Fraction determinant() const;
+
+  /*  Row reduces the matrix, turning it into reduced echelon form.          *
+   */
+  void reduce();
+
+  /*  Prints the matrix as Matrix::print() does, zeros and all.              *
+   */
+  void print(ostream &stream, const string &lineStart) const;
+
+ private:
+  /*  Compressed sparse rows: row i's entries are values[k], in columns      *
+   *    columns[k], for k from rowStarts[i] up to rowStarts[i + 1], in order *
+   *    of column.                                                           *
+   */
+  int rows;
+  int cols;
+  vector<int> rowStarts;
+  vector<int> columns;
+  vector<Fraction> values;
+
+  SparseMatrix combine(const SparseMatrix &rval, bool subtract) const;
+  bool hasNan() const;
+};
+
+#endif
@@ -0,0 +1,98 @@
+/*---------------------------------------------------------------------------*\
+ *                              staticFraction.h                             *
+ *                Interface for the StaticFraction class template            *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Represents a rational constant as a type, in the manner of std::ratio: *
+ *      StaticFraction<2, 6> is the type of the number 1/3, with its terms   *
+ *      reduced at compile time.  Arithmetic on such types yields further    *
+ *      types, so constants can be combined without any code running.        *
+ *    Each type converts to the equivalent Fraction, which is itself         *
+ *      computed at compile time.                                            *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -For example,                                                           *
+ *      typedef StaticFractionAdd<StaticFraction<1, 2>,                      *
+ *                                StaticFraction<1, 3> > FiveSixths;         *
+ *      static_assert(FiveSixths::num == 5 && FiveSixths::den == 6, "");     *
+ *      Fraction x = FiveSixths();                                           *
+ *   -The arithmetic is Fraction's own, so the results are exactly those     *
+ *      Fraction would give.  A result that is nan (a zero denominator, or   *
+ *      a term too large for a long long) fails to compile.                  *
+\*---------------------------------------------------------------------------*/
+#ifndef STATICFRACTION_CLASS_INCLUDED
+#define STATICFRACTION_CLASS_INCLUDED
+#include "fraction.h"
+
+/*  The signed numerator and the denominator of a fraction, as template      *
+ *    arguments for a StaticFraction.  A fraction whose numerator does not   *
+ *    fit in a long long is given as 1/0, which StaticFraction rejects.      *
+ */
+constexpr bool staticFits(const Fraction &value)
+{
+  unsigned long long limit = 1ULL << 63;
+  if (!value.isNegative()) limit--;
+  return !value.isNan() && value.getNumerator() <= limit;
+}
+
+constexpr long long staticNumerator(const Fraction &value)
+{
+  if (!staticFits(value)) return 1;
+  unsigned long long num = value.getNumerator();
+  return value.isNegative() ? (long long)(0ULL - num) : (long long)num;
+}
+
+constexpr long long staticDenominator(const Fraction &value)
+{
+  return staticFits(value) ? value.getDenominator() : 0;
+}
+
+
+template<long long N, long long D = 1>
+class StaticFraction
+{
+ public:
+  /*  The value as a Fraction, in lowest terms.                              */
+  static constexpr Fraction value = Fraction(N, D);
+  static_assert(!value.isNan(), "StaticFraction must not be nan");
+
+  /*  The reduced terms; the sign is carried by the numerator, as with       *
+   *    std::ratio.                                                          *
+   */
+  static constexpr long long num = staticNumerator(value);
+  static constexpr long long den = staticDenominator(value);
+
+  /*  The same number, with its terms reduced.                               */
+  typedef StaticFraction<num, den> type;
+
+  constexpr operator Fraction() const
+  {
+    return value;
+  }
+};
+
+
+/*  Arithmetic on StaticFractions, as with std::ratio_add and its kin.       *
+ *  Each is the StaticFraction, in lowest terms, of the result.              *
+ */
+template<class R1, class R2>
+using StaticFractionAdd =
+  StaticFraction<staticNumerator(R1::value + R2::value),
+                 staticDenominator(R1::value + R2::value)>;
+
+template<class R1, class R2>
+using StaticFractionSubtract =
+  StaticFraction<staticNumerator(R1::value - R2::value),
+                 staticDenominator(R1::value - R2::value)>;
+
+template<class R1, class R2>
+using StaticFractionMultiply =
+  StaticFraction<staticNumerator(R1::value * R2::value),
+                 staticDenominator(R1::value * R2::value)>;
+
+template<class R1, class R2>
+using StaticFractionDivide =
+  StaticFraction<staticNumerator(R1::value / R2::value),
+                 staticDenominator(R1::value / R2::value)>;
+
+#endif
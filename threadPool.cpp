@@ -0,0 +1,180 @@
+/*---------------------------------------------------------------------------*\
+ *                               threadPool.cpp                              *
+ *                   Implementation of the ThreadPool class                  *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    A pool of n threads starts n - 1 workers; the caller of parallelFor()  *
+ *    is the nth.  Workers sleep on wake until the generation changes, which *
+ *    marks a new task.  Every thread then takes the next unstarted block    *
+ *    under the lock, runs it without the lock, and counts it off once it is *
+ *    done; whoever finishes the last block signals the caller.              *
+\*---------------------------------------------------------------------------*/
+#include<condition_variable>
+#include<cstdlib>
+#include<functional>
+#include<mutex>
+#include<thread>
+#include<vector>
+#include "threadPool.h"
+using namespace std;
+
+/*  How many blocks to aim for per thread.  More than one lets threads that  *
+ *    finish early take up the slack from those that are slowed down.       *
+ */
+static const int BLOCKS_PER_THREAD = 4;
+
+/*  Handing a block to another thread costs about as much as this many       *
+ *    operations on matrix entries, so no block should have fewer.           *
+ */
+static const long long PARALLEL_GRAIN = 4096;
+
+
+/*  The size of the shared pool: CALC_THREADS, if it is a positive number,   *
+ *    and otherwise the number of processors.                                *
+ */
+static int defaultThreads()
+{
+  const char *setting = getenv("CALC_THREADS");
+  if (setting != NULL && atoi(setting) > 0) return atoi(setting);
+  return thread::hardware_concurrency();
+}
+
+
+ThreadPool::ThreadPool(int threads)
+{
+  task = NULL;
+  count = blockSize = nextBlock = blocksLeft = 0;
+  generation = 0;
+  stopping = false;
+  start(threads);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+  stop();
+}
+
+
+int ThreadPool::size() const
+{
+  return workers.size() + 1;
+}
+
+
+void ThreadPool::resize(int threads)
+{
+  if (threads < 1) threads = 1;
+  if (threads == size()) return;
+  stop();
+  start(threads);
+}
+
+
+/*  The block size is chosen so that each thread gets a few blocks, but no   *
+ *    block is smaller than minBlock.  Nested calls, and calls with too      *
+ *    little work to split, run on the calling thread alone.                 *
+ */
+void ThreadPool::parallelFor(int count, int minBlock,
+			     const function<void(int, int)> &task)
+{
+  if (count <= 0) return;
+  if (minBlock < 1) minBlock = 1;
+  unique_lock<mutex> held(lock);
+  if (workers.empty() || this->task != NULL || count < 2 * minBlock) {
+    held.unlock();
+    task(0, count);
+    return;
+  }
+  int blocks = size() * BLOCKS_PER_THREAD;
+  if (blocks > count / minBlock) blocks = count / minBlock;
+  this->task = &task;
+  this->count = count;
+  blockSize = (count + blocks - 1) / blocks;
+  nextBlock = 0;
+  blocksLeft = (count + blockSize - 1) / blockSize;
+  generation++;
+  wake.notify_all();
+
+  while (runBlock(held)) {}
+  while (blocksLeft > 0) {
+    finished.wait(held);
+  }
+  this->task = NULL;
+}
+
+
+int ThreadPool::minBlock(long long workPerIndex)
+{
+  if (workPerIndex < 1) workPerIndex = 1;
+  return (PARALLEL_GRAIN + workPerIndex - 1) / workPerIndex;
+}
+
+
+/*  The pool is created on first use.                                        */
+ThreadPool &ThreadPool::shared()
+{
+  static ThreadPool pool(defaultThreads());
+  return pool;
+}
+
+
+void ThreadPool::start(int threads)
+{
+  if (threads < 1) threads = 1;
+  stopping = false;
+  for (int i = 1; i < threads; i++) {
+    workers.push_back(thread(&ThreadPool::work, this));
+  }
+}
+
+
+void ThreadPool::stop()
+{
+  {
+    lock_guard<mutex> held(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  workers.clear();
+}
+
+
+/*  Each worker waits for a task it has not yet seen, then helps with it     *
+ *    until no blocks are left to start.                                     *
+ */
+void ThreadPool::work()
+{
+  unique_lock<mutex> held(lock);
+  unsigned seen = generation;
+  while (true) {
+    while (!stopping && generation == seen) {
+      wake.wait(held);
+    }
+    if (stopping) return;
+    seen = generation;
+    while (runBlock(held)) {}
+  }
+}
+
+
+/*  Takes the next block, if there is one, and runs it with the lock         *
+ *    released.  Returns false once every block has been started.            *
+ */
+bool ThreadPool::runBlock(unique_lock<mutex> &held)
+{
+  if (task == NULL || nextBlock * blockSize >= count) return false;
+  int begin = nextBlock * blockSize;
+  int end = begin + blockSize;
+  if (end > count) end = count;
+  nextBlock++;
+  const function<void(int, int)> &current = *task;
+  held.unlock();
+  current(begin, end);
+  held.lock();
+  if (--blocksLeft == 0) finished.notify_one();
+  return true;
+}
@@ -0,0 +1,87 @@
+/*---------------------------------------------------------------------------*\
+ *                                threadPool.h                               *
+ *                    Interface for the ThreadPool class                     *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Keeps a set of worker threads waiting, so that a loop can be split     *
+ *      across processors without starting a thread each time.              *
+ *    Work is given as a range of indices, such as the rows of a matrix,     *
+ *      which is divided into consecutive blocks; the threads take blocks    *
+ *      until none are left.                                                 *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -The thread that calls parallelFor() works on blocks too, and returns   *
+ *      only once every block is done.  A pool of one thread simply runs     *
+ *      the whole range itself.                                              *
+ *   -A task that itself calls parallelFor() on the same pool runs that      *
+ *      range by itself, rather than waiting on threads that are busy.       *
+ *   -The shared pool used by Matrix is sized by the CALC_THREADS            *
+ *      environment variable if it is set, and otherwise by the number of    *
+ *      processors; it can be resized at any time between tasks.             *
+\*---------------------------------------------------------------------------*/
+#ifndef THREADPOOL_CLASS_INCLUDED
+#define THREADPOOL_CLASS_INCLUDED
+#include<condition_variable>
+#include<functional>
+#include<mutex>
+#include<thread>
+#include<vector>
+using namespace std;
+
+class ThreadPool
+{
+ public:
+  /*  Creates a pool of the given number of threads, counting the one that   *
+   *    will call parallelFor(); fewer than one is taken as one.             *
+   */
+  ThreadPool(int threads);
+  ~ThreadPool();
+
+  /*  Give and change the number of threads.                                 *
+   */
+  int size() const;
+  void resize(int threads);
+
+  /*  Calls task(begin, end) for consecutive blocks [begin, end) covering    *
+   *    [0, count), spread across the pool's threads, and returns once all   *
+   *    of them are done.  Blocks hold at least minBlock indices, so that    *
+   *    small ranges are not split into pieces too small to be worth         *
+   *    handing out.                                                         *
+   */
+  void parallelFor(int count, int minBlock,
+                   const function<void(int, int)> &task);
+
+  /*  The fewest indices a block should hold, given how many operations on   *
+   *    matrix entries each index takes, for the block to be worth handing   *
+   *    to another thread.                                                   *
+   */
+  static int minBlock(long long workPerIndex);
+
+  /*  The pool shared by the matrix routines.                                *
+   */
+  static ThreadPool &shared();
+
+ private:
+  vector<thread> workers;
+  mutex lock;
+  condition_variable wake;              /* Signals workers: a task, or stop */
+  condition_variable finished;          /* Signals the caller: all done     */
+
+  const function<void(int, int)> *task; /* The current task, if running    */
+  int count;
+  int blockSize;
+  int nextBlock;                        /* Index of the next block to start */
+  int blocksLeft;                       /* Blocks not yet finished          */
+  unsigned generation;                  /* Counts tasks, to wake workers    */
+  bool stopping;
+
+  ThreadPool(const ThreadPool &);
+  ThreadPool &operator=(const ThreadPool &);
+
+  void start(int threads);
+  void stop();
+  void work();
+  bool runBlock(unique_lock<mutex> &held);
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*---------------------------------------------------------------------------*\
+ *                               tokenizer.cpp                               *
+ *                    Implementation of the Tokenizer class                  *
+ *                                                                           *
+ *  Note on representation:                                                  *
+ *    The current line of input, including its '\n', is held in a string,   *
+ *    along with the position of the next unread character.  A new line is  *
+ *    only read from the stream once the last one has been used up.  Number *
+ *    literals never span lines, so they are parsed from the string with    *
+ *    from_chars, rather than a character at a time.                        *
+\*---------------------------------------------------------------------------*/
+#include<iostream>
+#include<cctype>
+#include<charconv>
+#include<string>
+#include "fraction.h"
+#include "bigInteger.h"
+#include "bigRational.h"
+#include "tokenizer.h"
+using namespace std;
+
+/*  The most decimal digits that always fit in an unsigned long long.        */
+static const int CHUNK_DIGITS = 19;
+
+
+static bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+
+/*  Returns 10^exp, for exp <= CHUNK_DIGITS.                                 *
+ */
+static unsigned long long tenToThe(int exp)
+{
+  unsigned long long result = 1;
+  for (int i = 0; i < exp; i++) {
+    result *= 10;
+  }
+  return result;
+}
+
+
+/*  Appends the digits in [begin, end) to the given number, as though they   *
+ *    had been written after it.  Each chunk of up to CHUNK_DIGITS digits is *
+ *    converted by from_chars, then folded in with one multiply and one add. *
+ */
+static void appendDigits(const char *begin, const char *end,
+			 BigInteger *number)
+{
+  while (begin < end) {
+    const char *chunkEnd = end;
+    if (end - begin > CHUNK_DIGITS) chunkEnd = begin + CHUNK_DIGITS;
+    unsigned long long chunk = 0;
+    from_chars(begin, chunkEnd, chunk);
+    *number *= BigInteger(tenToThe(chunkEnd - begin), false);
+    *number += BigInteger(chunk, false);
+    begin = chunkEnd;
+  }
+}
+
+
+/*  Parses one decimal literal, [-]digits[.digits][e[+|-]digits], from the   *
+ *    characters in [begin, end).  Returns the position just past it, or     *
+ *    begin if there was none.                                               *
+ *  The value is mantissa * 10^(exponent - digits after the point), which is *
+ *    exact.  When the mantissa has at most CHUNK_DIGITS digits and the      *
+ *    power of ten is small enough to be a Fraction's denominator (10^18 at  *
+ *    most), as is almost always the case, no BigInteger arithmetic is       *
+ *    needed.                                                                *
+ */
+static const char *parseDecimal(const char *begin, const char *end,
+				BigRational *value)
+{
+  const char *p = begin;
+  bool negative = (p < end && *p == '-');
+  if (negative) p++;
+  const char *whole = p;
+  while (p < end && isDigit(*p)) p++;
+  const char *wholeEnd = p;
+  const char *fraction = p;
+  if (p < end && *p == '.') {
+    fraction = ++p;
+    while (p < end && isDigit(*p)) p++;
+  } else if (whole == wholeEnd) {
+    return begin;
+  }
+  const char *fractionEnd = p;
+
+  long long exponent = 0;
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *digits = p + 1;
+    bool negativeExponent = (digits < end && *digits == '-');
+    if (digits < end && (*digits == '-' || *digits == '+')) digits++;
+    if (digits < end && isDigit(*digits)) {
+      p = digits;
+      while (p < end && isDigit(*p)) p++;
+      if (from_chars(digits, p, exponent).ec != errc()) {
+	exponent = (long long)Tokenizer::MAX_EXPONENT + 1;
+      }
+      if (negativeExponent) exponent = -exponent;
+    }
+  }
+  if (exponent > Tokenizer::MAX_EXPONENT ||
+      exponent < -Tokenizer::MAX_EXPONENT) {
+    *value = BigRational(1, 0);
+    return p;
+  }
+
+  long long scale = exponent - (fractionEnd - fraction);
+  if ((wholeEnd - whole) + (fractionEnd - fraction) <= CHUNK_DIGITS &&
+      scale <= 0 && scale >= -CHUNK_DIGITS &&
+      tenToThe(-scale) <= Fraction::MAX_DENOMINATOR) {
+    unsigned long long mantissa = 0, fractionDigits = 0;
+    from_chars(whole, wholeEnd, mantissa);
+    from_chars(fraction, fractionEnd, fractionDigits);
+    mantissa = mantissa * tenToThe(fractionEnd - fraction) + fractionDigits;
+    *value = Fraction(0, mantissa, tenToThe(-scale));
+  } else {
+    BigInteger mantissa;
+    appendDigits(whole, wholeEnd, &mantissa);
+    appendDigits(fraction, fractionEnd, &mantissa);
+    if (scale >= 0) {
+      *value = mantissa * BigInteger(10).power(scale);
+    } else {
+      *value = BigRational(mantissa, BigInteger(10).power(-scale));
+    }
+  }
+  if (negative) *value = -*value;
+  return p;
+}
+
+
+Tokenizer::Tokenizer(istream &stream) : stream(stream), position(0)
+{
+}
+
+
+bool Tokenizer::get(char &c)
+{
+  if (position == line.size() && !fill()) return false;
+  c = line[position++];
+  return true;
+}
+
+
+void Tokenizer::putback()
+{
+  if (position > 0) position--;
+}
+
+
+bool Tokenizer::read(char *value)
+{
+  return skipWhitespace() && get(*value);
+}
+
+
+bool Tokenizer::read(int *value)
+{
+  if (!skipWhitespace()) return false;
+  const char *begin = line.data() + position;
+  from_chars_result result = from_chars(begin, line.data() + line.size(),
+					*value);
+  if (result.ec != errc()) return false;
+  position += result.ptr - begin;
+  return true;
+}
+
+
+/*  A fraction is two decimal literals separated by a slash.  The slash only *
+ *    belongs to the literal if a denominator follows it directly; "6 3/"    *
+ *    is still 6 divided by 3.                                               *
+ */
+bool Tokenizer::read(BigRational *value)
+{
+  if (!skipWhitespace()) return false;
+  const char *begin = line.data() + position;
+  const char *end = line.data() + line.size();
+  BigRational number;
+  const char *p = parseDecimal(begin, end, &number);
+  if (p == begin) return false;
+  if (end - p > 1 && *p == '/' &&
+      (isDigit(p[1]) || (end - p > 2 && p[1] == '.' && isDigit(p[2])))) {
+    BigRational denominator;
+    p = parseDecimal(p + 1, end, &denominator);
+    number /= denominator;
+  }
+  position = p - line.data();
+  *value = number;
+  return true;
+}
+
+
+/*  Reads the next line of input, keeping its '\n' unless the input ended    *
+ *    without one.  Returns false at the end of input.                       *
+ */
+bool Tokenizer::fill()
+{
+  position = 0;
+  if (!getline(stream, line)) {
+    line.clear();
+    return false;
+  }
+  if (!stream.eof()) line += '\n';
+  return true;
+}
+
+
+/*  Moves past any whitespace, reading more lines as needed.  Returns false  *
+ *    if the input ends first.                                               *
+ */
+bool Tokenizer::skipWhitespace()
+{
+  while (true) {
+    while (position < line.size() && isspace((unsigned char)line[position])) {
+      position++;
+    }
+    if (position < line.size()) return true;
+    if (!fill()) return false;
+  }
+}
@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------*\
+ *                                tokenizer.h                                *
+ *                     Interface for the Tokenizer class                     *
+ *                                                                           *
+ *  Purpose:                                                                 *
+ *    Reads the calculator's input from a stream, a line at a time, and      *
+ *      hands it out either as single characters (commands) or as whole      *
+ *      values (numbers).                                                    *
+ *    Numbers are parsed directly out of the buffered line, so reading a     *
+ *      long stream of literals does not go through the stream one           *
+ *      character at a time.                                                 *
+ *                                                                           *
+ *  Notes:                                                                   *
+ *   -Number literals may be written as:                                     *
+ *      integers               42                                            *
+ *      decimals               3.14     .5     2.                            *
+ *      scientific notation    1.5e-7   6E23                                 *
+ *      fractions              2/3      1.5/7  1e3/7                         *
+ *    and are converted exactly, at any size.  A fraction's slash must be    *
+ *      followed immediately by its denominator; otherwise the literal ends  *
+ *      before the slash.  Likewise, an 'e' only begins an exponent if its   *
+ *      digits follow.                                                       *
+ *   -Input is buffered a line at a time, so that interactive use still      *
+ *      responds to each line as it is entered.                              *
+\*---------------------------------------------------------------------------*/
+#ifndef TOKENIZER_CLASS_INCLUDED
+#define TOKENIZER_CLASS_INCLUDED
+#include<iostream>
+#include<string>
+#include "bigRational.h"
+using namespace std;
+
+class Tokenizer
+{
+ public:
+  /*  Reads from the given stream, which must outlive the tokenizer.         *
+   */
+  Tokenizer(istream &stream);
+
+  /*  Character access, as with an istream.                                  *
+   *  get() returns false at the end of input.  putback() returns the last   *
+   *    character read by get() to the input.                                *
+   */
+  bool get(char &c);
+  void putback();
+
+  /*  Read a value, first skipping whitespace (including newlines), as       *
+   *    operator>> would.  If no value of the right form is found, returns   *
+   *    false, and leaves the offending character unread.                    *
+   *  Numbers may be negative here, and take any of the forms above.  A      *
+   *    number whose exponent is larger than MAX_EXPONENT is nan.            *
+   */
+  bool read(char *value);
+  bool read(int *value);
+  bool read(BigRational *value);
+
+  /*  The largest exponent, in magnitude, that a literal may have.           *
+   */
+  static const int MAX_EXPONENT = 100000;
+
+ private:
+  istream &stream;
+  string line;
+  size_t position;
+
+  bool fill();
+  bool skipWhitespace();
+};
+
+#endif